@@ -110,10 +110,12 @@ private:
 	// Lighting
 	ci::gl::Light				*mLight;
 	bool						mLightEnabled;
+	bool						mLightEnabledPrev;
 
 	// Texture map
 	ci::gl::Texture				mTexture;
 	bool						mTextureEnabled;
+	bool						mTextureEnabledPrev;
 
 	// Params and utilities
 	float						mFrameRate;
@@ -137,16 +139,24 @@ using namespace std;
 // Creates VboMeshes
 void InstancedSampleApp::createMeshes()
 {
+	// Skip normals and texture coordinates when lighting or texturing is off, 
+	// and order triangles and vertices for the GPU's caches
+	uint32_t flags = ( mLightEnabled ? MeshHelper::ATTRIB_NORMAL : 0 ) | ( mTextureEnabled ? MeshHelper::ATTRIB_TEX_COORD : 0 ) | 
+		MeshHelper::OPTIMIZE_VERTEX_CACHE | MeshHelper::OPTIMIZE_VERTEX_FETCH;
+
+	// Closed shapes are drawn many times over, so also cut their overdraw
+	uint32_t closedFlags = flags | MeshHelper::OPTIMIZE_OVERDRAW;
+
 	// Use the MeshHelper to generate primitives
-	mCircle			= gl::VboMesh( MeshHelper::createCircle( mResolution.xy() ) );
-	mCone			= gl::VboMesh( MeshHelper::createCylinder( mResolution.xy(), 0.0f, 1.0f, false, true ) );
-	mCube			= gl::VboMesh( MeshHelper::createCube( mResolution ) );
-	mCylinder		= gl::VboMesh( MeshHelper::createCylinder( mResolution.xy() ) );
-	mIcosahedron	= gl::VboMesh( MeshHelper::createIcosahedron( mDivision ) );
-	mRing			= gl::VboMesh( MeshHelper::createRing( mResolution.xy() ) );
-	mSphere			= gl::VboMesh( MeshHelper::createSphere( mResolution.xy() ) );
-	mSquare			= gl::VboMesh( MeshHelper::createSquare( mResolution.xy() ) );
-	mTorus			= gl::VboMesh( MeshHelper::createTorus( mResolution.xy() ) );
+	mCircle			= gl::VboMesh( MeshHelper::createCircle( mResolution.xy(), flags ) );
+	mCone			= gl::VboMesh( MeshHelper::createCylinder( mResolution.xy(), 0.0f, 1.0f, false, true, flags ) );
+	mCube			= gl::VboMesh( MeshHelper::createCube( mResolution, closedFlags ) );
+	mCylinder		= gl::VboMesh( MeshHelper::createCylinder( mResolution.xy(), 1.0f, 1.0f, true, true, closedFlags ) );
+	mIcosahedron	= gl::VboMesh( MeshHelper::createIcosahedron( mDivision, closedFlags ) );
+	mRing			= gl::VboMesh( MeshHelper::createRing( mResolution.xy(), 0.5f, flags ) );
+	mSphere			= gl::VboMesh( MeshHelper::createSphere( mResolution.xy(), closedFlags ) );
+	mSquare			= gl::VboMesh( MeshHelper::createSquare( mResolution.xy(), flags ) );
+	mTorus			= gl::VboMesh( MeshHelper::createTorus( mResolution.xy(), 0.5f, closedFlags ) );
 	
 	/////////////////////////////////////////////////////////////////////////////
 	// Custom mesh
@@ -186,23 +196,16 @@ void InstancedSampleApp::createMeshes()
 			int32_t xn = x + 1 >= mResolution.x ? 0 : 1;
 			int32_t yn = y + 1 >= mResolution.y ? 0 : 1;
 			indices.push_back( x + mResolution.x * y );
-			indices.push_back( ( x + xn ) + mResolution.x * y);
 			indices.push_back( ( x + xn ) + mResolution.x * ( y + yn ) );
+			indices.push_back( ( x + xn ) + mResolution.x * y);
 			indices.push_back( x + mResolution.x * ( y + yn ) );
-			indices.push_back( ( x + xn ) + mResolution.x * ( y + yn ) );
 			indices.push_back( x + mResolution.x * y );
+			indices.push_back( ( x + xn ) + mResolution.x * ( y + yn ) );
 		}
 	}
 
-	// Iterate through again to set normals
-	for ( int32_t y = 0; y < mResolution.y - 1; y++ ) {
-		for ( int32_t x = 0; x < mResolution.x - 1; x++ ) {
-			Vec3f vert0 = positions[ indices[ ( x + mResolution.x * y ) * 6 ] ];
-			Vec3f vert1 = positions[ indices[ ( ( x + 1 ) + mResolution.x * y ) * 6 ] ];
-			Vec3f vert2 = positions[ indices[ ( ( x + 1 ) + mResolution.x * ( y + 1 ) ) * 6 ] ];
-			normals[ x + mResolution.x * y ] = Vec3f( ( vert1 - vert0 ).cross( vert1 - vert2 ).normalized() );
-		}
-	}
+	// Compute smooth normals from the triangles
+	MeshHelper::computeNormals( &indices[ 0 ], indices.size(), &positions[ 0 ], positions.size(), &normals[ 0 ] );
 
 	// Use the MeshHelper to create a VboMesh from our vectors
 	mCustom = gl::VboMesh( MeshHelper::create( indices, positions, normals, texCoords ) );
@@ -376,11 +379,13 @@ void InstancedSampleApp::setup()
 	mFrameRate			= 0.0f;
 	mFullScreen			= false;
 	mLightEnabled		= true;
+	mLightEnabledPrev	= mLightEnabled;
 	mMeshIndex			= 0;
 	mResolution			= Vec3i::one() * 12;
 	mResolutionPrev		= mResolution;
 	mScale				= Vec3f::one() * 0.25f;
 	mTextureEnabled		= true;
+	mTextureEnabledPrev	= mTextureEnabled;
 	mWireframe			= false;
 	
 	// Set up the arcball
@@ -461,12 +466,16 @@ void InstancedSampleApp::update()
 		setFullScreen( mFullScreen );
 	}
 
-	// Reset the meshes if the segment count changes
-	if ( mDivisionPrev	!= mDivision || 
-		mResolutionPrev != mResolution ) {
+	// Reset the meshes if the segment count or attributes change
+	if ( mDivisionPrev		!= mDivision || 
+		mLightEnabledPrev	!= mLightEnabled || 
+		mResolutionPrev		!= mResolution || 
+		mTextureEnabledPrev	!= mTextureEnabled ) {
 		createMeshes();
-		mDivisionPrev	= mDivision;
-		mResolutionPrev = mResolution;
+		mDivisionPrev		= mDivision;
+		mLightEnabledPrev	= mLightEnabled;
+		mResolutionPrev		= mResolution;
+		mTextureEnabledPrev	= mTextureEnabled;
 	}
 
 	// Update light on every frame
@@ -177,23 +177,16 @@ void TriMeshSampleApp::createMeshes()
 			int32_t xn = x + 1 >= mResolution.x ? 0 : 1;
 			int32_t yn = y + 1 >= mResolution.y ? 0 : 1;
 			indices.push_back( x + mResolution.x * y );
-			indices.push_back( ( x + xn ) + mResolution.x * y);
 			indices.push_back( ( x + xn ) + mResolution.x * ( y + yn ) );
+			indices.push_back( ( x + xn ) + mResolution.x * y);
 			indices.push_back( x + mResolution.x * ( y + yn ) );
-			indices.push_back( ( x + xn ) + mResolution.x * ( y + yn ) );
 			indices.push_back( x + mResolution.x * y );
+			indices.push_back( ( x + xn ) + mResolution.x * ( y + yn ) );
 		}
 	}
 
-	// Iterate through again to set normals
-	for ( int32_t y = 0; y < mResolution.y - 1; y++ ) {
-		for ( int32_t x = 0; x < mResolution.x - 1; x++ ) {
-			Vec3f vert0 = positions[ indices[ ( x + mResolution.x * y ) * 6 ] ];
-			Vec3f vert1 = positions[ indices[ ( ( x + 1 ) + mResolution.x * y ) * 6 ] ];
-			Vec3f vert2 = positions[ indices[ ( ( x + 1 ) + mResolution.x * ( y + 1 ) ) * 6 ] ];
-			normals[ x + mResolution.x * y ] = Vec3f( ( vert1 - vert0 ).cross( vert1 - vert2 ).normalized() );
-		}
-	}
+	// Compute smooth normals from the triangles
+	MeshHelper::computeNormals( &indices[ 0 ], indices.size(), &positions[ 0 ], positions.size(), &normals[ 0 ] );
 
 	// Use the MeshHelper to create a TriMesh from our vectors
 	mCustom = MeshHelper::create( indices, positions, normals, texCoords );
@@ -35,715 +35,4023 @@
 
 #include "MeshHelper.h"
 
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#define MESHHELPER_SSE
+#include <xmmintrin.h>
+#endif
+
 using namespace ci;
 using namespace std;
 
-TriMesh MeshHelper::create( vector<uint32_t> &indices, const vector<Vec3f> &positions, 
-	const vector<Vec3f> &normals, const vector<Vec2f> &texCoords )
+// Converts \a value to a half float, rounding to nearest even.
+static uint16_t floatToHalf( float value )
 {
-	TriMesh mesh;
-	if ( indices.size() > 0 ) {
-		mesh.appendIndices( &indices[ 0 ], indices.size() );
-	}
-	if ( normals.size() > 0 ) {
-		for ( vector<Vec3f>::const_iterator iter = normals.begin(); iter != normals.end(); ++iter ) {
-			mesh.appendNormal( *iter );
+	uint32_t bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	uint32_t sign		= ( bits >> 16 ) & 0x8000;
+	int32_t exponent	= (int32_t)( ( bits >> 23 ) & 0xFF ) - 127 + 15;
+	uint32_t mantissa	= bits & 0x007FFFFF;
+
+	if ( exponent >= 31 ) {
+		// Overflow becomes infinity, NaN stays NaN
+		bool nan = ( ( bits >> 23 ) & 0xFF ) == 0xFF && mantissa != 0;
+		return (uint16_t)( sign | 0x7C00 | ( nan ? 0x0200 : 0 ) );
+	} else if ( exponent <= 0 ) {
+		if ( exponent < -10 ) {
+			return (uint16_t)sign;
 		}
+		// Subnormal
+		mantissa		|= 0x00800000;
+		uint32_t shift	= (uint32_t)( 14 - exponent );
+		uint32_t half	= mantissa >> shift;
+		uint32_t rest	= mantissa & ( ( 1u << shift ) - 1 );
+		uint32_t middle	= 1u << ( shift - 1 );
+		if ( rest > middle || ( rest == middle && ( half & 1 ) != 0 ) ) {
+			++half;
+		}
+		return (uint16_t)( sign | half );
 	}
-	if ( positions.size() > 0 ) {
-		mesh.appendVertices( &positions[ 0 ], positions.size() );
+
+	uint32_t half	= sign | ( (uint32_t)exponent << 10 ) | ( mantissa >> 13 );
+	uint32_t rest	= mantissa & 0x1FFF;
+	if ( rest > 0x1000 || ( rest == 0x1000 && ( half & 1 ) != 0 ) ) {
+		++half;
 	}
-	if ( texCoords.size() > 0 ) {
-		for ( vector<Vec2f>::const_iterator iter = texCoords.begin(); iter != texCoords.end(); ++iter ) {
-			mesh.appendTexCoord( *iter );
+	return (uint16_t)half;
+}
+
+static float halfToFloat( uint16_t value )
+{
+	uint32_t sign		= (uint32_t)( value & 0x8000 ) << 16;
+	uint32_t exponent	= ( value >> 10 ) & 0x1F;
+	uint32_t mantissa	= value & 0x03FF;
+
+	uint32_t bits;
+	if ( exponent == 0 ) {
+		if ( mantissa == 0 ) {
+			bits = sign;
+		} else {
+			// Normalize the subnormal
+			exponent = 127 - 15 + 1;
+			while ( ( mantissa & 0x0400 ) == 0 ) {
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits = sign | ( exponent << 23 ) | ( ( mantissa & 0x03FF ) << 13 );
 		}
+	} else if ( exponent == 31 ) {
+		bits = sign | 0x7F800000 | ( mantissa << 13 );
+	} else {
+		bits = sign | ( ( exponent - 15 + 127 ) << 23 ) | ( mantissa << 13 );
 	}
-	return mesh;
+
+	float result;
+	memcpy( &result, &bits, sizeof( result ) );
+	return result;
 }
 
-TriMesh MeshHelper::createCircle( const Vec2i &resolution )
+static int16_t floatToSnorm16( float value )
 {
-	return createRing( resolution, 0.0f );
+	return (int16_t)math<float>::floor( math<float>::clamp( value, -1.0f, 1.0f ) * 32767.0f + 0.5f );
 }
 
-TriMesh MeshHelper::createCube( const Vec3i &resolution )
+static float snorm16ToFloat( int16_t value )
 {
-	vector<uint32_t> indices;
-	vector<Vec3f> normals;
-	vector<Vec3f> positions;
-	vector<Vec2f> texCoords;
+	return math<float>::max( (float)value / 32767.0f, -1.0f );
+}
 
-	ci::TriMesh front	= createSquare( Vec2i( resolution.x, resolution.y ) );
-	ci::TriMesh left	= createSquare( Vec2i( resolution.z, resolution.y ) );
-	ci::TriMesh top		= createSquare( Vec2i( resolution.x, resolution.z ) );
-	
-	Vec3f normal;
-	Vec3f offset;
-	Matrix44f transform;
-
-	// Back
-	normal = Vec3f( 0.0f, 0.0f, -1.0f );
-	offset = normal * 0.5f;
-	transform.setToIdentity();
-	transform.translate( offset );
-	for ( vector<Vec3f>::iterator iter = front.getVertices().begin(); iter != front.getVertices().end(); ++iter ) {
-		positions.push_back( transform.transformPoint( *iter ) );
-		normals.push_back( normal );
-	}
-	for ( vector<Vec2f>::iterator iter = front.getTexCoords().begin(); iter != front.getTexCoords().end(); ++iter ) {
-		texCoords.push_back( *iter );
-	}
-
-	// Bottom
-	normal = Vec3f( 0.0f, -1.0f, 0.0f );
-	offset = normal * 0.5f;
-	transform.setToIdentity();
-	transform.translate( offset );
-	transform.rotate( Vec3f( -(float)M_PI * 0.5f, 0.0f, 0.0f ) );
-	transform.translate( offset * -1.0f );
-	transform.translate( offset );
-	for ( vector<Vec3f>::iterator iter = top.getVertices().begin(); iter != top.getVertices().end(); ++iter ) {
-		positions.push_back( transform.transformPoint( *iter ) );
-		normals.push_back( normal );
-	}
-	for ( vector<Vec2f>::iterator iter = top.getTexCoords().begin(); iter != top.getTexCoords().end(); ++iter ) {
-		texCoords.push_back( *iter );
-	}
-
-	normal = Vec3f( 0.0f, 0.0f, 1.0f );
-	offset = normal * 0.5f;
-	transform.setToIdentity();
-	transform.translate( offset );
-	for ( vector<Vec3f>::iterator iter = front.getVertices().begin(); iter != front.getVertices().end(); ++iter ) {
-		positions.push_back( transform.transformPoint( *iter ) );
-		normals.push_back( normal );
-	}
-	for ( vector<Vec2f>::iterator iter = front.getTexCoords().begin(); iter != front.getTexCoords().end(); ++iter ) {
-		texCoords.push_back( *iter );
-	}
-
-	normal = Vec3f( -1.0f, 0.0f, 0.0f );
-	offset = normal * 0.5f;
-	transform.setToIdentity();
-	transform.translate( offset );
-	transform.rotate( Vec3f( 0.0f, -(float)M_PI * 0.5f, 0.0f ) );
-	transform.translate( offset * -1.0f );
-	transform.translate( offset );
-	for ( vector<Vec3f>::iterator iter = left.getVertices().begin(); iter != left.getVertices().end(); ++iter ) {
-		positions.push_back( transform.transformPoint( *iter ) );
-		normals.push_back( normal );
-	}
-	for ( vector<Vec2f>::iterator iter = left.getTexCoords().begin(); iter != left.getTexCoords().end(); ++iter ) {
-		texCoords.push_back( *iter );
-	}
-
-	// Right
-	normal = Vec3f( 1.0f, 0.0f, 0.0f );
-	offset = normal * 0.5f;
-	transform.setToIdentity();
-	transform.translate( offset );
-	transform.rotate( Vec3f( 0.0f, (float)M_PI * 0.5f, 0.0f ) );
-	transform.translate( offset * -1.0f );
-	transform.translate( offset );
-	for ( vector<Vec3f>::iterator iter = left.getVertices().begin(); iter != left.getVertices().end(); ++iter ) {
-		positions.push_back( transform.transformPoint( *iter ) );
-		normals.push_back( normal );
-	}
-	for ( vector<Vec2f>::iterator iter = left.getTexCoords().begin(); iter != left.getTexCoords().end(); ++iter ) {
-		texCoords.push_back( *iter );
-	}
-
-	normal = Vec3f( 0.0f, 1.0f, 0.0f );
-	offset = normal * 0.5f;
-	transform.setToIdentity();
-	transform.translate( offset );
-	transform.rotate( Vec3f( (float)M_PI * 0.5f, 0.0f, 0.0f ) );
-	transform.translate( offset * -1.0f );
-	transform.translate( offset );
-	for ( vector<Vec3f>::iterator iter = top.getVertices().begin(); iter != top.getVertices().end(); ++iter ) {
-		positions.push_back( transform.transformPoint( *iter ) );
-		normals.push_back( normal );
-	}
-	for ( vector<Vec2f>::iterator iter = top.getTexCoords().begin(); iter != top.getTexCoords().end(); ++iter ) {
-		texCoords.push_back( *iter );
-	}
-
-	for ( uint32_t i = 0; i < positions.size(); ++i ) {
-		indices.push_back( i );
-	}
-
-	TriMesh mesh = MeshHelper::create( indices, positions, normals, texCoords );
-
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	texCoords.clear();
+static uint16_t floatToUnorm16( float value )
+{
+	return (uint16_t)math<float>::floor( math<float>::clamp( value, 0.0f, 1.0f ) * 65535.0f + 0.5f );
+}
 
-	return mesh;
+static float unorm16ToFloat( uint16_t value )
+{
+	return (float)value / 65535.0f;
 }
 
-TriMesh MeshHelper::createCylinder( const Vec2i &resolution, float topRadius, float baseRadius, bool closeTop, bool closeBase )
+static float signNotZero( float value )
 {
-	vector<uint32_t> indices;
-	vector<Vec3f> normals;
-	vector<Vec3f> positions;
-	vector<Vec3f> srcNormals;
-	vector<Vec3f> srcPositions;
-	vector<Vec2f> srcTexCoords;
-	vector<Vec2f> texCoords;
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
 
-	float delta = ( 2.0f * (float)M_PI ) / (float)resolution.x;
-	float step	= 1.0f / (float)resolution.y;
-	float ud	= 1.0f / (float)resolution.x;
+VertexFormat::VertexFormat( bool normals, bool texCoords, size_t alignment )
+	: mNormalOffset( 0 ), mNormalType( normals ? NORMAL_FLOAT : NORMAL_NONE ), mPositionOffset( 0 ), 
+	mPositionType( POSITION_FLOAT ), mStride( 0 ), mTexCoordOffset( 0 ), 
+	mTexCoordType( texCoords ? TEX_COORD_FLOAT : TEX_COORD_NONE )
+{
+	layout( alignment );
+}
 
-	int32_t p = 0;
-	for ( float phi = 0.0f; p <= resolution.y; ++p, phi += step ) {
-		int32_t t	= 0;
-		float u		= 0.0f;
-		for ( float theta = 0.0f; t < resolution.x; ++t, u += ud, theta += delta ) {
+VertexFormat::VertexFormat( PositionType position, NormalType normal, TexCoordType texCoord, size_t alignment )
+	: mNormalOffset( 0 ), mNormalType( normal ), mPositionOffset( 0 ), mPositionType( position ), mStride( 0 ), 
+	mTexCoordOffset( 0 ), mTexCoordType( texCoord )
+{
+	layout( alignment );
+}
 
-			float radius = lerp( baseRadius, topRadius, phi );
+void VertexFormat::layout( size_t alignment )
+{
+	mStride = mPositionType == POSITION_FLOAT ? sizeof( Vec3f ) : sizeof( uint16_t ) * 4;
+	if ( mNormalType != NORMAL_NONE ) {
+		mNormalOffset	= mStride;
+		mStride			+= mNormalType == NORMAL_FLOAT ? sizeof( Vec3f ) : sizeof( int16_t ) * 2;
+	}
+	if ( mTexCoordType != TEX_COORD_NONE ) {
+		mTexCoordOffset	= mStride;
+		mStride			+= mTexCoordType == TEX_COORD_FLOAT ? sizeof( Vec2f ) : sizeof( uint16_t ) * 2;
+	}
+	if ( alignment > 1 ) {
+		mStride = ( ( mStride + alignment - 1 ) / alignment ) * alignment;
+	}
+}
 
-			Vec3f position( 
-				math<float>::cos( theta ) * radius, 
-				phi - 0.5f, 
-				math<float>::sin( theta ) * radius
-				);
-			srcPositions.push_back( position );
+bool VertexFormat::isQuantized() const
+{
+	return mPositionType != POSITION_FLOAT || mNormalType == NORMAL_OCT16 || mTexCoordType == TEX_COORD_UNORM16;
+}
 
-			Vec3f normal = Vec3f( position.x, 0.0f, position.z ).normalized();
-			normal.y = 0.0f;
-			srcNormals.push_back( normal );
+Vec3f VertexFormat::decodeNormal( const void *data ) const
+{
+	if ( mNormalType != NORMAL_OCT16 ) {
+		Vec3f normal;
+		memcpy( &normal, data, sizeof( Vec3f ) );
+		return normal;
+	}
 
-			Vec2f texCoord( u, phi );
-			srcTexCoords.push_back( texCoord );
-		}
+	int16_t encoded[ 2 ];
+	memcpy( encoded, data, sizeof( encoded ) );
+	Vec3f normal( snorm16ToFloat( encoded[ 0 ] ), snorm16ToFloat( encoded[ 1 ] ), 0.0f );
+	normal.z = 1.0f - math<float>::abs( normal.x ) - math<float>::abs( normal.y );
+	if ( normal.z < 0.0f ) {
+		float x		= ( 1.0f - math<float>::abs( normal.y ) ) * signNotZero( normal.x );
+		float y		= ( 1.0f - math<float>::abs( normal.x ) ) * signNotZero( normal.y );
+		normal.x	= x;
+		normal.y	= y;
 	}
+	return normal.normalized();
+}
 
-	srcNormals.push_back( Vec3f( 0.0f, 1.0f, 0.0f ) );
-	srcNormals.push_back( Vec3f( 0.0f, -1.0f, 0.0f ) );
-	srcPositions.push_back( Vec3f( 0.0f, -0.5f, 0.0f ) );
-	srcPositions.push_back( Vec3f( 0.0f, 0.5f, 0.0f ) );
-	srcTexCoords.push_back( Vec2f( 0.0f, 0.0f ) );
-	srcTexCoords.push_back( Vec2f( 0.0f, 1.0f ) );
-	int32_t topCenter		= (int32_t)srcPositions.size() - 1;
-	int32_t bottomCenter	= topCenter - 1;
+Vec3f VertexFormat::decodePosition( const void *data ) const
+{
+	Vec3f position;
+	if ( mPositionType == POSITION_FLOAT ) {
+		memcpy( &position, data, sizeof( Vec3f ) );
+	} else if ( mPositionType == POSITION_HALF ) {
+		uint16_t encoded[ 3 ];
+		memcpy( encoded, data, sizeof( encoded ) );
+		position = Vec3f( halfToFloat( encoded[ 0 ] ), halfToFloat( encoded[ 1 ] ), halfToFloat( encoded[ 2 ] ) );
+	} else {
+		int16_t encoded[ 3 ];
+		memcpy( encoded, data, sizeof( encoded ) );
+		position = Vec3f( snorm16ToFloat( encoded[ 0 ] ), snorm16ToFloat( encoded[ 1 ] ), snorm16ToFloat( encoded[ 2 ] ) );
+	}
+	return position;
+}
 
-	if ( closeTop ) {
-		for ( int32_t t = 0; t < resolution.x; ++t ) {
-			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+Vec2f VertexFormat::decodeTexCoord( const void *data ) const
+{
+	Vec2f texCoord;
+	if ( mTexCoordType == TEX_COORD_UNORM16 ) {
+		uint16_t encoded[ 2 ];
+		memcpy( encoded, data, sizeof( encoded ) );
+		texCoord = Vec2f( unorm16ToFloat( encoded[ 0 ] ), unorm16ToFloat( encoded[ 1 ] ) );
+	} else {
+		memcpy( &texCoord, data, sizeof( Vec2f ) );
+	}
+	return texCoord;
+}
 
-			normals.push_back( srcNormals[ topCenter ] );
-			normals.push_back( srcNormals[ topCenter ] );
-			normals.push_back( srcNormals[ topCenter ] );
+void VertexFormat::encodeNormal( void *data, const Vec3f &normal ) const
+{
+	if ( mNormalType != NORMAL_OCT16 ) {
+		memcpy( data, &normal, sizeof( Vec3f ) );
+		return;
+	}
 
-			positions.push_back( srcPositions[ topCenter ] );
-			positions.push_back( srcPositions[ ( resolution.x * resolution.y ) + n ] );
-			positions.push_back( srcPositions[ ( resolution.x * resolution.y ) + t ] );
+	// Project onto the octahedron, then fold the lower half over the upper
+	float length = math<float>::abs( normal.x ) + math<float>::abs( normal.y ) + math<float>::abs( normal.z );
+	Vec2f folded = length > 0.0f ? Vec2f( normal.x, normal.y ) / length : Vec2f( 0.0f, 0.0f );
+	if ( normal.z < 0.0f ) {
+		folded = Vec2f( 
+			( 1.0f - math<float>::abs( folded.y ) ) * signNotZero( folded.x ), 
+			( 1.0f - math<float>::abs( folded.x ) ) * signNotZero( folded.y ) 
+			);
+	}
+	int16_t encoded[ 2 ] = { floatToSnorm16( folded.x ), floatToSnorm16( folded.y ) };
+	memcpy( data, encoded, sizeof( encoded ) );
+}
 
-			texCoords.push_back( srcTexCoords[ topCenter ] );
-			texCoords.push_back( srcTexCoords[ topCenter ] );
-			texCoords.push_back( srcTexCoords[ topCenter ] );
-		}
+void VertexFormat::encodePosition( void *data, const Vec3f &position ) const
+{
+	if ( mPositionType == POSITION_FLOAT ) {
+		memcpy( data, &position, sizeof( Vec3f ) );
+	} else if ( mPositionType == POSITION_HALF ) {
+		uint16_t encoded[ 4 ] = { floatToHalf( position.x ), floatToHalf( position.y ), floatToHalf( position.z ), 0 };
+		memcpy( data, encoded, sizeof( encoded ) );
+	} else {
+		int16_t encoded[ 4 ] = { floatToSnorm16( position.x ), floatToSnorm16( position.y ), floatToSnorm16( position.z ), 0 };
+		memcpy( data, encoded, sizeof( encoded ) );
 	}
+}
 
-	for ( int32_t p = 0; p < resolution.y; ++p ) {
-		for ( int32_t t = 0; t < resolution.x; ++t ) {
-			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
-		
-			int32_t index0 = ( p + 0 ) * resolution.x + t;
-			int32_t index1 = ( p + 0 ) * resolution.x + n;
-			int32_t index2 = ( p + 1 ) * resolution.x + t;
-			int32_t index3 = ( p + 1 ) * resolution.x + n;
+void VertexFormat::encodeTexCoord( void *data, const Vec2f &texCoord ) const
+{
+	if ( mTexCoordType == TEX_COORD_UNORM16 ) {
+		uint16_t encoded[ 2 ] = { floatToUnorm16( texCoord.x ), floatToUnorm16( texCoord.y ) };
+		memcpy( data, encoded, sizeof( encoded ) );
+	} else {
+		memcpy( data, &texCoord, sizeof( Vec2f ) );
+	}
+}
 
-			normals.push_back( srcNormals[ index0 ] );
-			normals.push_back( srcNormals[ index2 ] );
-			normals.push_back( srcNormals[ index1 ] );
-			normals.push_back( srcNormals[ index1 ] );
-			normals.push_back( srcNormals[ index2 ] );
-			normals.push_back( srcNormals[ index3 ] );
+// Tables by segment count. Past a limit the cache is emptied, which callers 
+// still holding a table don't notice.
+static mutex							sSinCosMutex;
+static map<uint32_t, SinCosTableRef>	sSinCosTables;
 
-			positions.push_back( srcPositions[ index0 ] );
-			positions.push_back( srcPositions[ index2 ] );
-			positions.push_back( srcPositions[ index1 ] );
-			positions.push_back( srcPositions[ index1 ] );
-			positions.push_back( srcPositions[ index2 ] );
-			positions.push_back( srcPositions[ index3 ] );
+SinCosTableRef SinCosTable::get( uint32_t numSegments )
+{
+	lock_guard<mutex> lock( sSinCosMutex );
+	map<uint32_t, SinCosTableRef>::const_iterator iter = sSinCosTables.find( numSegments );
+	if ( iter != sSinCosTables.end() ) {
+		return iter->second;
+	}
+	if ( sSinCosTables.size() >= 64 ) {
+		sSinCosTables.clear();
+	}
+	SinCosTableRef table( new SinCosTable( numSegments ) );
+	sSinCosTables[ numSegments ] = table;
+	return table;
+}
 
-			texCoords.push_back( srcTexCoords[ index0 ] );
-			texCoords.push_back( srcTexCoords[ index2 ] );
-			texCoords.push_back( srcTexCoords[ index1 ] );
-			texCoords.push_back( srcTexCoords[ index1 ] );
-			texCoords.push_back( srcTexCoords[ index2 ] );
-			texCoords.push_back( srcTexCoords[ index3 ] );
-		}
+SinCosTable::SinCosTable( uint32_t numSegments )
+	: mCos( numSegments + 1, 1.0f ), mNumSegments( numSegments ), mSin( numSegments + 1, 0.0f )
+{
+	// Values within rounding of zero are snapped, so quarter turns are exact
+	double delta = numSegments > 0 ? ( 2.0 * M_PI ) / (double)numSegments : 0.0;
+	for ( uint32_t i = 0; i <= numSegments; ++i ) {
+		double angle	= (double)i * delta;
+		double c		= math<double>::cos( angle );
+		double s		= math<double>::sin( angle );
+		mCos[ i ]		= math<double>::abs( c ) < 1e-12 ? 0.0f : (float)c;
+		mSin[ i ]		= math<double>::abs( s ) < 1e-12 ? 0.0f : (float)s;
 	}
+}
+
+InterleavedMesh::InterleavedMesh( const VertexFormat &format )
+	: mFormat( format )
+{
+}
 
-	if ( closeBase ) {
-		for ( int32_t t = 0; t < resolution.x; ++t ) {
-			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+void InterleavedMesh::clear()
+{
+	mIndices.clear();
+	mVertices.clear();
+}
 
-			normals.push_back( srcNormals[ bottomCenter ] );
-			normals.push_back( srcNormals[ bottomCenter ] );
-			normals.push_back( srcNormals[ bottomCenter ] );
+void TriMesh16::clear()
+{
+	mDrawRanges.clear();
+	mIndices.clear();
+	mNormals.clear();
+	mTexCoords.clear();
+	mVertices.clear();
+}
 
-			positions.push_back( srcPositions[ bottomCenter ] );
-			positions.push_back( srcPositions[ n ] );
-			positions.push_back( srcPositions[ t ] );
+void LodChain::clear()
+{
+	mLevels.clear();
+	mMesh.clear();
+	mParentPositions.clear();
+	mVertexLevels.clear();
+}
 
-			texCoords.push_back( srcTexCoords[ bottomCenter ] );
-			texCoords.push_back( srcTexCoords[ bottomCenter ] );
-			texCoords.push_back( srcTexCoords[ bottomCenter ] );
-		}
+float LodChain::getMorphFactor( size_t level, float distance, float projectionScale, float maxPixelError ) const
+{
+	if ( level + 1 >= mLevels.size() || distance <= 0.0f || maxPixelError <= 0.0f ) {
+		return 0.0f;
 	}
+	float pixels = mLevels[ level + 1 ].mError * projectionScale / distance;
+	return math<float>::clamp( 2.0f - pixels / maxPixelError, 0.0f, 1.0f );
+}
 
-	for ( uint32_t i = 0; i < positions.size(); ++i ) {
-		indices.push_back( i );
+size_t LodChain::selectLevel( float distance, float projectionScale, float maxPixelError ) const
+{
+	if ( distance <= 0.0f ) {
+		return 0;
 	}
-			
-	TriMesh mesh = MeshHelper::create( indices, positions, normals, texCoords );
-		
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	srcNormals.clear();
-	srcPositions.clear();
-	srcTexCoords.clear();
-	texCoords.clear();
+	for ( size_t i = mLevels.size(); i > 1; --i ) {
+		if ( mLevels[ i - 1 ].mError * projectionScale / distance <= maxPixelError ) {
+			return i - 1;
+		}
+	}
+	return 0;
+}
 
-	return mesh;
+MeshletMesh::MeshletMesh( uint32_t maxVertices, uint32_t maxTriangles )
+	: mMaxTriangles( math<uint32_t>::max( maxTriangles, 1 ) ), mMaxVertices( math<uint32_t>::clamp( maxVertices, 3, 255 ) )
+{
 }
 
-TriMesh MeshHelper::createIcosahedron( uint32_t division )
+void MeshletMesh::clear()
 {
-	vector<Vec3f> positions;
-	vector<Vec3f> normals;
-	vector<Vec2f> texCoords;
-	vector<uint32_t> indices;
-
-	const float t	= 0.5f + 0.5f * math<float>::sqrt( 5.0f );
-	const float one	= 1.0f / math<float>::sqrt( 1.0f + t * t );
-	const float tau	= t * one;
-	const float pi	= (float)M_PI;
-
-	normals.push_back( Vec3f(  one, 0.0f,  tau) );	
-	normals.push_back( Vec3f(  one, 0.0f, -tau) );	
-	normals.push_back( Vec3f( -one, 0.0f, -tau) );		
-	normals.push_back( Vec3f( -one, 0.0f,  tau) );		
-
-	normals.push_back( Vec3f(  tau,  one, 0.0f ) );
-	normals.push_back( Vec3f( -tau,  one, 0.0f ) );	
-	normals.push_back( Vec3f( -tau, -one, 0.0f ) );
-	normals.push_back( Vec3f(  tau, -one, 0.0f ) );
-
-	normals.push_back( Vec3f( 0.0f,  tau,  one) );
-	normals.push_back( Vec3f( 0.0f, -tau,  one) );	
-	normals.push_back( Vec3f( 0.0f, -tau, -one) );		
-	normals.push_back( Vec3f( 0.0f,  tau, -one) );		
-
-	for ( size_t i = 0; i < 12; ++i ) { 
-		positions.push_back( normals[ i ] * 0.5f );
-	}
-
-	static const size_t numIndices = 60;
-	uint32_t indexArray[ numIndices ] = { 
-		0, 8, 3,	0, 3, 9, 
-		1, 2, 11,	1, 10, 2, 
-		4, 0, 7,	4, 7, 1, 
-		6, 3, 5,	6, 5, 2, 
-		8, 4, 11,	8, 11, 5, 
-		9, 10, 7,	9, 6, 10, 
-		8, 0, 4,	11, 4, 1, 
-		0, 9, 7,	1, 7, 10, 
-		3, 8, 5,	2, 5, 11, 
-		3, 6, 9,	2, 10, 6 
-	};
-	for ( size_t i = 0; i < numIndices; ++i ) {
-		indices.push_back( indexArray[ i ] );
+	mMeshlets.clear();
+	mTriangles.clear();
+	mVertices.clear();
+}
+
+float MeshletMesh::getTriangleFill() const
+{
+	if ( mMeshlets.empty() ) {
+		return 0.0f;
 	}
+	return (float)( mTriangles.size() / 3 ) / (float)( mMeshlets.size() * mMaxTriangles );
+}
 
-	for ( vector<Vec3f>::const_iterator iter = normals.begin(); iter != normals.end(); ++iter ) {
-		float u = 0.5f + 0.5f * math<float>::atan2( iter->x, iter->z ) / pi;
-		float v = 0.5f - math<float>::asin( iter->y ) / pi;
-		Vec2f texCoord( u, v );
-		texCoords.push_back( texCoord );
+float MeshletMesh::getVertexFill() const
+{
+	if ( mMeshlets.empty() ) {
+		return 0.0f;
 	}
+	return (float)mVertices.size() / (float)( mMeshlets.size() * mMaxVertices );
+}
 
-	TriMesh mesh = MeshHelper::create( indices, positions, normals, texCoords );
+MeshBuilder::MeshBuilder( TriMesh &mesh )
+	: mAttribs( MeshHelper::ATTRIB_ALL ), mIndexCapacity( 0 ), mIndices( 0 ), mIndices16( 0 ), 
+	mInterleavedMesh( 0 ), mMesh( &mesh ), mMesh16( 0 ), mNormals( 0 ), mNormalStride( sizeof( Vec3f ) ), 
+	mNumIndices( 0 ), mNumVertices( 0 ), mPositions( 0 ), mPositionStride( sizeof( Vec3f ) ), 
+	mQuantized( false ), mTexCoords( 0 ), mTexCoordStride( sizeof( Vec2f ) ), mVertexCapacity( 0 )
+{
+}
 
-	if ( division > 1 ) {
-		mesh = subdivide( mesh, division, true );
-	}
+MeshBuilder::MeshBuilder( TriMesh &mesh, uint32_t attribs )
+	: mAttribs( attribs ), mIndexCapacity( 0 ), mIndices( 0 ), mIndices16( 0 ), mInterleavedMesh( 0 ), 
+	mMesh( &mesh ), mMesh16( 0 ), mNormals( 0 ), mNormalStride( sizeof( Vec3f ) ), mNumIndices( 0 ), 
+	mNumVertices( 0 ), mPositions( 0 ), mPositionStride( sizeof( Vec3f ) ), mQuantized( false ), 
+	mTexCoords( 0 ), mTexCoordStride( sizeof( Vec2f ) ), mVertexCapacity( 0 )
+{
+}
 
-	// TODO create star
+MeshBuilder::MeshBuilder( InterleavedMesh &mesh )
+	: mAttribs( MeshHelper::ATTRIB_ALL ), mIndexCapacity( 0 ), mIndices( 0 ), mIndices16( 0 ), 
+	mInterleavedMesh( &mesh ), mMesh( 0 ), mMesh16( 0 ), mNormals( 0 ), mNormalStride( 0 ), mNumIndices( 0 ), 
+	mNumVertices( 0 ), mPositions( 0 ), mPositionStride( 0 ), mQuantized( false ), mTexCoords( 0 ), 
+	mTexCoordStride( 0 ), mVertexCapacity( 0 )
+{
+}
 
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	texCoords.clear();
+MeshBuilder::MeshBuilder( TriMesh16 &mesh )
+	: mAttribs( MeshHelper::ATTRIB_ALL ), mIndexCapacity( 0 ), mIndices( 0 ), mIndices16( 0 ), 
+	mInterleavedMesh( 0 ), mMesh( 0 ), mMesh16( &mesh ), mNormals( 0 ), mNormalStride( sizeof( Vec3f ) ), 
+	mNumIndices( 0 ), mNumVertices( 0 ), mPositions( 0 ), mPositionStride( sizeof( Vec3f ) ), 
+	mQuantized( false ), mTexCoords( 0 ), mTexCoordStride( sizeof( Vec2f ) ), mVertexCapacity( 0 )
+{
+}
 
-	return mesh;
+MeshBuilder::MeshBuilder( TriMesh16 &mesh, uint32_t attribs )
+	: mAttribs( attribs ), mIndexCapacity( 0 ), mIndices( 0 ), mIndices16( 0 ), mInterleavedMesh( 0 ), 
+	mMesh( 0 ), mMesh16( &mesh ), mNormals( 0 ), mNormalStride( sizeof( Vec3f ) ), mNumIndices( 0 ), 
+	mNumVertices( 0 ), mPositions( 0 ), mPositionStride( sizeof( Vec3f ) ), mQuantized( false ), 
+	mTexCoords( 0 ), mTexCoordStride( sizeof( Vec2f ) ), mVertexCapacity( 0 )
+{
 }
 
-TriMesh MeshHelper::createRing( const Vec2i &resolution, float ratio )
+MeshBuilder::MeshBuilder( uint32_t *indices, size_t numIndices, Vec3f *positions, Vec3f *normals, 
+	Vec2f *texCoords, size_t numVertices )
+	: mAttribs( MeshHelper::ATTRIB_ALL ), mIndexCapacity( numIndices ), mIndices( indices ), mIndices16( 0 ), 
+	mInterleavedMesh( 0 ), mMesh( 0 ), mMesh16( 0 ), mNormals( reinterpret_cast<uint8_t*>( normals ) ), 
+	mNormalStride( sizeof( Vec3f ) ), mNumIndices( 0 ), mNumVertices( 0 ), 
+	mPositions( reinterpret_cast<uint8_t*>( positions ) ), mPositionStride( sizeof( Vec3f ) ), 
+	mQuantized( false ), mTexCoords( reinterpret_cast<uint8_t*>( texCoords ) ), 
+	mTexCoordStride( sizeof( Vec2f ) ), mVertexCapacity( numVertices )
 {
-	vector<uint32_t> indices;
-	vector<Vec3f> normals;
-	vector<Vec3f> positions;
-	vector<Vec2f> texCoords;
+}
+
+MeshBuilder::MeshBuilder( uint16_t *indices, size_t numIndices, Vec3f *positions, Vec3f *normals, 
+	Vec2f *texCoords, size_t numVertices )
+	: mAttribs( MeshHelper::ATTRIB_ALL ), mIndexCapacity( numIndices ), mIndices( 0 ), mIndices16( indices ), 
+	mInterleavedMesh( 0 ), mMesh( 0 ), mMesh16( 0 ), mNormals( reinterpret_cast<uint8_t*>( normals ) ), 
+	mNormalStride( sizeof( Vec3f ) ), mNumIndices( 0 ), mNumVertices( 0 ), 
+	mPositions( reinterpret_cast<uint8_t*>( positions ) ), mPositionStride( sizeof( Vec3f ) ), 
+	mQuantized( false ), mTexCoords( reinterpret_cast<uint8_t*>( texCoords ) ), 
+	mTexCoordStride( sizeof( Vec2f ) ), mVertexCapacity( math<size_t>::min( numVertices, 65535 ) )
+{
+}
 
-	Vec3f norm0( 0.0f, 0.0f, 1.0f );
+MeshBuilder::MeshBuilder( uint32_t *indices, size_t numIndices, void *vertices, const VertexFormat &format, 
+	size_t numVertices )
+	: mAttribs( MeshHelper::ATTRIB_ALL ), mIndexCapacity( numIndices ), mIndices( indices ), mIndices16( 0 ), 
+	mInterleavedMesh( 0 ), mMesh( 0 ), mMesh16( 0 ), mNormals( 0 ), mNormalStride( 0 ), mNumIndices( 0 ), 
+	mNumVertices( 0 ), mPositions( 0 ), mPositionStride( 0 ), mQuantized( false ), mTexCoords( 0 ), 
+	mTexCoordStride( 0 ), mVertexCapacity( numVertices )
+{
+	setVertices( static_cast<uint8_t*>( vertices ), format );
+}
 
-	float delta = ( (float)M_PI * 2.0f ) / (float)resolution.x;
-	float width	= 1.0f - ratio;
-	float step	= width / (float)resolution.y;
+MeshBuilder::MeshBuilder( uint16_t *indices, size_t numIndices, void *vertices, const VertexFormat &format, 
+	size_t numVertices )
+	: mAttribs( MeshHelper::ATTRIB_ALL ), mIndexCapacity( numIndices ), mIndices( 0 ), mIndices16( indices ), 
+	mInterleavedMesh( 0 ), mMesh( 0 ), mMesh16( 0 ), mNormals( 0 ), mNormalStride( 0 ), mNumIndices( 0 ), 
+	mNumVertices( 0 ), mPositions( 0 ), mPositionStride( 0 ), mQuantized( false ), mTexCoords( 0 ), 
+	mTexCoordStride( 0 ), mVertexCapacity( math<size_t>::min( numVertices, 65535 ) )
+{
+	setVertices( static_cast<uint8_t*>( vertices ), format );
+}
 
-	int32_t p = 0;
-	for ( float phi = 0.0f; p < resolution.y; ++p, phi += step ) {
+bool MeshBuilder::allocate( size_t numVertices, size_t numIndices )
+{
+	if ( mMesh != 0 ) {
+		bool normals	= ( mAttribs & MeshHelper::ATTRIB_NORMAL ) != 0 && numVertices > 0;
+		bool texCoords	= ( mAttribs & MeshHelper::ATTRIB_TEX_COORD ) != 0 && numVertices > 0;
+		mMesh->getIndices().resize( numIndices );
+		mMesh->getNormals().resize( normals ? numVertices : 0 );
+		mMesh->getVertices().resize( numVertices );
+		mMesh->getTexCoords().resize( texCoords ? numVertices : 0 );
+
+		mIndices	= numIndices > 0 ? &mMesh->getIndices()[ 0 ] : 0;
+		mNormals	= normals ? reinterpret_cast<uint8_t*>( &mMesh->getNormals()[ 0 ] ) : 0;
+		mPositions	= numVertices > 0 ? reinterpret_cast<uint8_t*>( &mMesh->getVertices()[ 0 ] ) : 0;
+		mTexCoords	= texCoords ? reinterpret_cast<uint8_t*>( &mMesh->getTexCoords()[ 0 ] ) : 0;
+	} else if ( mInterleavedMesh != 0 ) {
+		const VertexFormat &format = mInterleavedMesh->getFormat();
+		mInterleavedMesh->getIndices().resize( numIndices );
+		mInterleavedMesh->getVertices().assign( numVertices * format.getStride(), 0 );
+
+		mIndices = numIndices > 0 ? &mInterleavedMesh->getIndices()[ 0 ] : 0;
+		setVertices( numVertices > 0 ? &mInterleavedMesh->getVertices()[ 0 ] : 0, format );
+	} else if ( mMesh16 != 0 ) {
+		if ( numVertices > 65535 ) {
+			return false;
+		}
+		bool normals	= ( mAttribs & MeshHelper::ATTRIB_NORMAL ) != 0 && numVertices > 0;
+		bool texCoords	= ( mAttribs & MeshHelper::ATTRIB_TEX_COORD ) != 0 && numVertices > 0;
+		mMesh16->getIndices().resize( numIndices );
+		mMesh16->getNormals().resize( normals ? numVertices : 0 );
+		mMesh16->getVertices().resize( numVertices );
+		mMesh16->getTexCoords().resize( texCoords ? numVertices : 0 );
+
+		DrawRange range = { 0, 0, (uint32_t)numIndices, (uint32_t)numVertices };
+		mMesh16->getDrawRanges().assign( numIndices > 0 ? 1 : 0, range );
+
+		mIndices16	= numIndices > 0 ? &mMesh16->getIndices()[ 0 ] : 0;
+		mNormals	= normals ? reinterpret_cast<uint8_t*>( &mMesh16->getNormals()[ 0 ] ) : 0;
+		mPositions	= numVertices > 0 ? reinterpret_cast<uint8_t*>( &mMesh16->getVertices()[ 0 ] ) : 0;
+		mTexCoords	= texCoords ? reinterpret_cast<uint8_t*>( &mMesh16->getTexCoords()[ 0 ] ) : 0;
+	} else if ( numVertices > mVertexCapacity || numIndices > mIndexCapacity || 
+		( numVertices > 0 && mPositions == 0 ) || ( numIndices > 0 && mIndices == 0 && mIndices16 == 0 ) ) {
+		return false;
+	}
+	mNumIndices		= numIndices;
+	mNumVertices	= numVertices;
+	return true;
+}
 
-		float innerRadius = phi + 0.0f + ratio;
-		float outerRadius = phi + step + ratio;
+void MeshBuilder::setVertices( uint8_t *vertices, const VertexFormat &format )
+{
+	mFormat				= format;
+	mQuantized			= format.isQuantized();
+	mNormals			= vertices != 0 && format.hasNormals() ? vertices + format.getNormalOffset() : 0;
+	mNormalStride		= format.getStride();
+	mPositions			= vertices != 0 ? vertices + format.getPositionOffset() : 0;
+	mPositionStride		= format.getStride();
+	mTexCoords			= vertices != 0 && format.hasTexCoords() ? vertices + format.getTexCoordOffset() : 0;
+	mTexCoordStride		= format.getStride();
+}
 
-		int32_t t = 0;
-		for ( float theta = 0.0f; t < resolution.x; ++t, theta += delta ) {
-			float ct	= math<float>::cos( theta );
-			float st	= math<float>::sin( theta );
-			float ctn	= math<float>::cos( theta + delta );
-			float stn	= math<float>::sin( theta + delta );
+TriMesh MeshHelper::create( vector<uint32_t> &indices, const vector<Vec3f> &positions, 
+	const vector<Vec3f> &normals, const vector<Vec2f> &texCoords )
+{
+	TriMesh mesh;
+	mesh.getIndices()	= indices;
+	mesh.getNormals()	= normals;
+	mesh.getVertices()	= positions;
+	mesh.getTexCoords()	= texCoords;
+	return mesh;
+}
 
-			Vec3f pos0 = Vec3f( ct, st, 0.0f ) * innerRadius;
-			Vec3f pos1 = Vec3f( ctn, stn, 0.0f ) * innerRadius;
-			Vec3f pos2 = Vec3f( ct, st, 0.0f ) * outerRadius;
-			Vec3f pos3 = Vec3f( ctn, stn, 0.0f ) * outerRadius;
-			if ( t >= resolution.x - 1 ) {
-				ctn		= math<float>::cos( 0.0f );
-				stn		= math<float>::sin( 0.0f );
-				pos1	= Vec3f( ctn, stn, 0.0f ) * innerRadius;
-				pos3	= Vec3f( ctn, stn, 0.0f ) * outerRadius;
-			}
+TriMesh MeshHelper::create( vector<uint32_t> &&indices, vector<Vec3f> &&positions, 
+	vector<Vec3f> &&normals, vector<Vec2f> &&texCoords )
+{
+	TriMesh mesh;
+	mesh.getIndices().swap( indices );
+	mesh.getNormals().swap( normals );
+	mesh.getVertices().swap( positions );
+	mesh.getTexCoords().swap( texCoords );
+	return mesh;
+}
+
+TriMesh16 MeshHelper::split( const TriMesh &triMesh, uint32_t maxVertices )
+{
+	TriMesh16 mesh;
+	const vector<uint32_t> &indices	= triMesh.getIndices();
+	const vector<Vec3f> &normals	= triMesh.getNormals();
+	const vector<Vec3f> &positions	= triMesh.getVertices();
+	const vector<Vec2f> &texCoords	= triMesh.getTexCoords();
+	size_t numIndices				= ( indices.size() / 3 ) * 3;
+	size_t numVertices				= positions.size();
+	bool hasNormals					= normals.size() == numVertices;
+	bool hasTexCoords				= texCoords.size() == numVertices;
+	maxVertices						= math<uint32_t>::clamp( maxVertices, 3, 65535 );
+	for ( size_t i = 0; i < numIndices; ++i ) {
+		if ( indices[ i ] >= numVertices ) {
+			throw out_of_range( "MeshHelper::split: index out of range" );
+		}
+	}
+
+	// Small meshes keep their vertices as they are
+	if ( numVertices <= maxVertices ) {
+		mesh.getIndices().assign( indices.begin(), indices.begin() + numIndices );
+		mesh.getVertices() = positions;
+		if ( hasNormals ) {
+			mesh.getNormals() = normals;
+		}
+		if ( hasTexCoords ) {
+			mesh.getTexCoords() = texCoords;
+		}
+		if ( numIndices > 0 ) {
+			DrawRange range = { 0, 0, (uint32_t)numIndices, (uint32_t)numVertices };
+			mesh.getDrawRanges().push_back( range );
+		}
+		return mesh;
+	}
 
-			Vec2f texCoord0 = ( pos0.xy() + Vec2f::one() ) * 0.5f;
-			Vec2f texCoord1 = ( pos1.xy() + Vec2f::one() ) * 0.5f;
-			Vec2f texCoord2 = ( pos2.xy() + Vec2f::one() ) * 0.5f;
-			Vec2f texCoord3 = ( pos3.xy() + Vec2f::one() ) * 0.5f;
+	// Walk the triangles in order, giving each range its own block of 
+	// vertices. A range is closed when the next triangle would overflow it.
+	static const uint32_t unused = 0xFFFFFFFF;
+	vector<uint32_t> local( numVertices, unused );
+	vector<uint32_t> used;
+	used.reserve( maxVertices );
+	mesh.getIndices().reserve( numIndices );
+	mesh.getVertices().reserve( numVertices );
+
+	DrawRange range = { 0, 0, 0, 0 };
+	for ( size_t i = 0; i < numIndices; i += 3 ) {
+		const uint32_t *triangle = &indices[ i ];
+		uint32_t numNew = 0;
+		for ( size_t k = 0; k < 3; ++k ) {
+			bool repeated = ( k > 0 && triangle[ k ] == triangle[ 0 ] ) || ( k > 1 && triangle[ k ] == triangle[ 1 ] );
+			if ( !repeated && local[ triangle[ k ] ] == unused ) {
+				++numNew;
+			}
+		}
 
-			positions.push_back( pos0 );
-			positions.push_back( pos2 );
-			positions.push_back( pos1 );
-			positions.push_back( pos1 );
-			positions.push_back( pos2 );
-			positions.push_back( pos3 );
+		if ( used.size() + numNew > maxVertices ) {
+			range.mNumVertices = (uint32_t)used.size();
+			mesh.getDrawRanges().push_back( range );
+			for ( vector<uint32_t>::const_iterator iter = used.begin(); iter != used.end(); ++iter ) {
+				local[ *iter ] = unused;
+			}
+			used.clear();
+			range.mBaseVertex	= (uint32_t)mesh.getVertices().size();
+			range.mFirstIndex	= (uint32_t)mesh.getIndices().size();
+			range.mNumIndices	= 0;
+		}
 
-			texCoords.push_back( texCoord0 );
-			texCoords.push_back( texCoord2 );
-			texCoords.push_back( texCoord1 );
-			texCoords.push_back( texCoord1 );
-			texCoords.push_back( texCoord2 );
-			texCoords.push_back( texCoord3 );
+		for ( size_t k = 0; k < 3; ++k ) {
+			uint32_t index = triangle[ k ];
+			if ( local[ index ] == unused ) {
+				local[ index ] = (uint32_t)used.size();
+				used.push_back( index );
+				mesh.getVertices().push_back( positions[ index ] );
+				if ( hasNormals ) {
+					mesh.getNormals().push_back( normals[ index ] );
+				}
+				if ( hasTexCoords ) {
+					mesh.getTexCoords().push_back( texCoords[ index ] );
+				}
+			}
+			mesh.getIndices().push_back( (uint16_t)local[ index ] );
 		}
+		range.mNumIndices += 3;
+	}
+	if ( range.mNumIndices > 0 ) {
+		range.mNumVertices = (uint32_t)used.size();
+		mesh.getDrawRanges().push_back( range );
 	}
 
-	for ( uint32_t i = 0; i < positions.size(); ++i ) {
-		indices.push_back( i );
-		normals.push_back( norm0 );
+	return mesh;
+}
+
+QuantizationError MeshHelper::measureQuantizationError( const InterleavedMesh &mesh, const TriMesh &reference )
+{
+	const VertexFormat &format		= mesh.getFormat();
+	const vector<Vec3f> &normals	= reference.getNormals();
+	const vector<Vec3f> &positions	= reference.getVertices();
+	const vector<Vec2f> &texCoords	= reference.getTexCoords();
+	size_t numVertices				= math<size_t>::min( mesh.getNumVertices(), positions.size() );
+	bool hasNormals					= format.hasNormals() && normals.size() >= numVertices;
+	bool hasTexCoords				= format.hasTexCoords() && texCoords.size() >= numVertices;
+
+	QuantizationError error;
+	error.mMaxNormalAngle		= 0.0f;
+	error.mMaxPosition			= 0.0f;
+	error.mMaxTexCoord			= 0.0f;
+	error.mMeanNormalAngle		= 0.0f;
+	error.mMeanPosition			= 0.0f;
+	error.mNumBytes				= mesh.getVertices().size();
+	error.mNumReferenceBytes	= positions.size() * sizeof( Vec3f ) + normals.size() * sizeof( Vec3f ) + 
+		texCoords.size() * sizeof( Vec2f );
+
+	double normalSum	= 0.0;
+	double positionSum	= 0.0;
+	const uint8_t *data	= mesh.getVertices().empty() ? 0 : &mesh.getVertices()[ 0 ];
+	for ( size_t i = 0; i < numVertices; ++i, data += format.getStride() ) {
+		float distance		= format.decodePosition( data + format.getPositionOffset() ).distance( positions[ i ] );
+		error.mMaxPosition	= math<float>::max( error.mMaxPosition, distance );
+		positionSum			+= distance;
+
+		if ( hasNormals ) {
+			// acos cannot resolve angles below about 0.02 degrees in 
+			// float, which is coarser than oct16, so this uses atan2
+			Vec3f normal			= format.decodeNormal( data + format.getNormalOffset() );
+			Vec3f expected			= normals[ i ].normalized();
+			float angle				= toDegrees( math<float>::atan2( normal.cross( expected ).length(), normal.dot( expected ) ) );
+			error.mMaxNormalAngle	= math<float>::max( error.mMaxNormalAngle, angle );
+			normalSum				+= angle;
+		}
+		if ( hasTexCoords ) {
+			float distance		= format.decodeTexCoord( data + format.getTexCoordOffset() ).distance( texCoords[ i ] );
+			error.mMaxTexCoord	= math<float>::max( error.mMaxTexCoord, distance );
+		}
+	}
+	if ( numVertices > 0 ) {
+		error.mMeanNormalAngle	= hasNormals ? (float)( normalSum / (double)numVertices ) : 0.0f;
+		error.mMeanPosition		= (float)( positionSum / (double)numVertices );
 	}
 
-	TriMesh mesh = MeshHelper::create( indices, positions, normals, texCoords );
+	return error;
+}
 
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	texCoords.clear();
+InterleavedMesh MeshHelper::interleave( const TriMesh &triMesh, const VertexFormat &format )
+{
+	InterleavedMesh mesh( format );
+	MeshBuilder builder( mesh );
+	builder.allocate( triMesh.getNumVertices(), triMesh.getNumIndices() );
+
+	const vector<Vec3f> &normals	= triMesh.getNormals();
+	const vector<Vec3f> &positions	= triMesh.getVertices();
+	const vector<Vec2f> &texCoords	= triMesh.getTexCoords();
+	bool hasNormals					= normals.size() == positions.size();
+	bool hasTexCoords				= texCoords.size() == positions.size();
+	for ( size_t i = 0; i < positions.size(); ++i ) {
+		builder.setPosition( i, positions[ i ] );
+		if ( hasNormals ) {
+			builder.setNormal( i, normals[ i ] );
+		}
+		if ( hasTexCoords ) {
+			builder.setTexCoord( i, texCoords[ i ] );
+		}
+	}
+	if ( !triMesh.getIndices().empty() ) {
+		copy( triMesh.getIndices().begin(), triMesh.getIndices().end(), mesh.getIndices().begin() );
+	}
 
 	return mesh;
 }
 
-TriMesh MeshHelper::createSphere( const Vec2i &resolution )
+// Runs the optional passes requested in \a flags on a generated mesh.
+static void applyFlags( TriMesh &mesh, uint32_t flags )
 {
-	vector<uint32_t> indices;
-	vector<Vec3f> normals;
-	vector<Vec3f> positions;
-	vector<Vec2f> texCoords;
+	if ( ( flags & ( MeshHelper::OPTIMIZE_VERTEX_CACHE | MeshHelper::OPTIMIZE_OVERDRAW ) ) != 0 ) {
+		MeshHelper::optimizeVertexCache( mesh );
+	}
+	if ( ( flags & MeshHelper::OPTIMIZE_OVERDRAW ) != 0 ) {
+		MeshHelper::optimizeOverdraw( mesh );
+	}
+	if ( ( flags & MeshHelper::OPTIMIZE_VERTEX_FETCH ) != 0 ) {
+		MeshHelper::optimizeVertexFetch( mesh );
+	}
+}
 
-	float step = (float)M_PI / (float)resolution.y;
-	float delta = ((float)M_PI * 2.0f) / (float)resolution.x;
+void MeshHelper::optimize( TriMesh &triMesh, uint32_t flags )
+{
+	applyFlags( triMesh, flags );
+}
 
-	int32_t p = 0;
-	for ( float phi = 0.0f; p <= resolution.y; p++, phi += step ) {
-		int32_t t = 0;
+TriMesh MeshHelper::createCircle( const Vec2i &resolution, uint32_t flags, MeshBounds *bounds )
+{
+	return createRing( resolution, 0.0f, flags, bounds );
+}
 
-		uint32_t a = (uint32_t)( ( p + 0 ) * resolution.x );
-		uint32_t b = (uint32_t)( ( p + 1 ) * resolution.x );
+bool MeshHelper::createCircle( MeshBuilder &builder, const Vec2i &resolution, MeshBounds *bounds )
+{
+	return createRing( builder, resolution, 0.0f, bounds );
+}
 
-		for ( float theta = delta; t < resolution.x; t++, theta += delta ) {
-			float sinPhi = math<float>::sin( phi );
-			float x = sinPhi * math<float>::cos( theta );
-			float y = sinPhi * math<float>::sin( theta );
-			float z = -math<float>::cos( phi );
-			Vec3f position( x, y, z );
-			Vec3f normal = position.normalized();
-			Vec2f texCoord = ( normal.xy() + Vec2f::one() ) * 0.5f;
+TriMesh MeshHelper::createCube( const Vec3i &resolution, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( createCube( builder, resolution, bounds ) ) {
+		applyFlags( mesh, flags );
+	}
+	return mesh;
+}
 
-			normals.push_back( normal );
-			positions.push_back( position );
-			texCoords.push_back( texCoord ); 
+bool MeshHelper::createCube( MeshBuilder &builder, const Vec3i &resolution, MeshBounds *bounds )
+{
+	if ( !buildCube( builder, resolution ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = getCubeBounds( resolution );
+	}
+	return true;
+}
 
-			uint32_t n = (uint32_t)( t + 1 >= resolution.x ? 0 : t + 1 );
-			indices.push_back( a + t );
-			indices.push_back( b + t );
-			indices.push_back( a + n );
-			indices.push_back( a + n );
-			indices.push_back( b + t );
-			indices.push_back( b + n );
-		}
+TriMesh MeshHelper::createCylinder( const Vec2i &resolution, float topRadius, float baseRadius, bool closeTop, bool closeBase, 
+	uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( createCylinder( builder, resolution, topRadius, baseRadius, closeTop, closeBase, bounds ) ) {
+		applyFlags( mesh, flags );
 	}
+	return mesh;
+}
 
-	for ( vector<uint32_t>::iterator iter = indices.begin(); iter != indices.end(); ) {
-		if ( *iter < positions.size() ) {
-			++iter;
-		} else {
-			iter = indices.erase( iter );
-		}
+bool MeshHelper::createCylinder( MeshBuilder &builder, const Vec2i &resolution, float topRadius, float baseRadius, 
+	bool closeTop, bool closeBase, MeshBounds *bounds )
+{
+	if ( !buildCylinder( builder, resolution, topRadius, baseRadius, closeTop, closeBase ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = getCylinderBounds( resolution, topRadius, baseRadius );
 	}
+	return true;
+}
 
-	TriMesh mesh = MeshHelper::create( indices, positions, normals, texCoords );
+const uint32_t* MeshHelper::getGeosphereFace( size_t face )
+{
+	static const uint32_t faces[ 20 ][ 3 ] = { 
+		{ 0, 8, 3 },	{ 0, 3, 9 }, 
+		{ 1, 2, 11 },	{ 1, 10, 2 }, 
+		{ 4, 0, 7 },	{ 4, 7, 1 }, 
+		{ 6, 3, 5 },	{ 6, 5, 2 }, 
+		{ 8, 4, 11 },	{ 8, 11, 5 }, 
+		{ 9, 10, 7 },	{ 9, 6, 10 }, 
+		{ 8, 0, 4 },	{ 11, 4, 1 }, 
+		{ 0, 9, 7 },	{ 1, 7, 10 }, 
+		{ 3, 8, 5 },	{ 2, 5, 11 }, 
+		{ 3, 6, 9 },	{ 2, 10, 6 } 
+	};
+	return faces[ face ];
+}
 
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	texCoords.clear();
+void MeshHelper::numberGeosphereEdges( int32_t ( &edgeIds )[ 12 ][ 12 ], uint32_t ( &edgeCorners )[ 30 ][ 2 ] )
+{
+	for ( size_t i = 0; i < 12; ++i ) {
+		for ( size_t j = 0; j < 12; ++j ) {
+			edgeIds[ i ][ j ] = -1;
+		}
+	}
 
-	return mesh;
+	uint32_t numEdges = 0;
+	for ( size_t f = 0; f < 20; ++f ) {
+		const uint32_t *face = getGeosphereFace( f );
+		for ( size_t k = 0; k < 3; ++k ) {
+			uint32_t a = math<uint32_t>::min( face[ k ], face[ ( k + 1 ) % 3 ] );
+			uint32_t b = math<uint32_t>::max( face[ k ], face[ ( k + 1 ) % 3 ] );
+			if ( edgeIds[ a ][ b ] < 0 ) {
+				edgeIds[ a ][ b ]				= (int32_t)numEdges;
+				edgeIds[ b ][ a ]				= (int32_t)numEdges;
+				edgeCorners[ numEdges ][ 0 ]	= a;
+				edgeCorners[ numEdges ][ 1 ]	= b;
+				++numEdges;
+			}
+		}
+	}
 }
 
-TriMesh MeshHelper::createSquare( const Vec2i &resolution )
+void MeshHelper::getGeosphereLattice( const int32_t ( &edgeIds )[ 12 ][ 12 ], uint32_t frequency, uint32_t face, 
+	uint32_t *lattice )
 {
-	vector<uint32_t> indices;
-	vector<Vec3f> normals;
-	vector<Vec3f> positions;
-	vector<Vec2f> texCoords;
+	const uint32_t *corners	= getGeosphereFace( face );
+	uint32_t n				= math<uint32_t>::max( frequency, 1 );
+	uint32_t perEdge		= n - 1;
+	uint32_t perFace		= n > 2 ? ( n - 1 ) * ( n - 2 ) / 2 : 0;
+	uint32_t edgeBase		= 12;
+	uint32_t interior		= edgeBase + 30 * perEdge + face * perFace;
+	for ( uint32_t j = 0; j <= n; ++j ) {
+		for ( uint32_t i = 0; i + j <= n; ++i ) {
+			if ( j == 0 ) {
+				lattice[ i ] = getGeosphereEdgeVertex( edgeIds, edgeBase, perEdge, n, corners[ 0 ], corners[ 1 ], i );
+			} else if ( i == 0 ) {
+				lattice[ i ] = getGeosphereEdgeVertex( edgeIds, edgeBase, perEdge, n, corners[ 0 ], corners[ 2 ], j );
+			} else if ( i + j == n ) {
+				lattice[ i ] = getGeosphereEdgeVertex( edgeIds, edgeBase, perEdge, n, corners[ 1 ], corners[ 2 ], j );
+			} else {
+				lattice[ i ] = interior++;
+			}
+		}
+		lattice += n - j + 1;
+	}
+}
 
-	Vec3f norm0( 0.0f, 0.0f, 1.0f ); 
+uint32_t MeshHelper::getGeosphereEdgeVertex( const int32_t ( &edgeIds )[ 12 ][ 12 ], uint32_t edgeBase, 
+	uint32_t perEdge, uint32_t n, uint32_t from, uint32_t to, uint32_t k )
+{
+	if ( k == 0 ) {
+		return from;
+	} else if ( k == n ) {
+		return to;
+	}
+	uint32_t edge = edgeBase + (uint32_t)edgeIds[ from ][ to ] * perEdge;
+	return from < to ? edge + k - 1 : edge + n - k - 1;
+}
 
-	Vec2f scale( 1.0f / math<float>::max( (float)resolution.x, 1.0f ), 1.0f / math<float>::max( (float)resolution.y, 1.0f ) );
-	uint32_t index = 0;
-	for ( int32_t y = 0; y < resolution.y; ++y ) {
-		for ( int32_t x = 0; x < resolution.x; ++x, ++index ) {
+const uint32_t MeshHelper::kMaxGeosphereFrequency;
+const uint32_t MeshHelper::kMaxIcosahedronDivision;
 
-			float x1 = (float)x * scale.x;
-			float y1 = (float)y * scale.y;
-			float x2 = (float)( x + 1 ) * scale.x;
-			float y2 = (float)( y + 1 ) * scale.y;
+TriMesh MeshHelper::createGeosphere( uint32_t frequency, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( createGeosphere( builder, frequency, bounds ) ) {
+		applyFlags( mesh, flags );
+	}
+	return mesh;
+}
 
-			Vec3f pos0( x1 - 0.5f, y1 - 0.5f, 0.0f );
-			Vec3f pos1( x2 - 0.5f, y1 - 0.5f, 0.0f );
-			Vec3f pos2( x1 - 0.5f, y2 - 0.5f, 0.0f );
-			Vec3f pos3( x2 - 0.5f, y2 - 0.5f, 0.0f );
-				
-			Vec2f texCoord0( x1, y1 );
-			Vec2f texCoord1( x2, y1 );
-			Vec2f texCoord2( x1, y2 );
-			Vec2f texCoord3( x2, y2 );
+bool MeshHelper::createGeosphere( MeshBuilder &builder, uint32_t frequency, MeshBounds *bounds )
+{
+	if ( !buildGeosphere( builder, frequency ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = getGeosphereBounds();
+	}
+	return true;
+}
 
-			positions.push_back( pos2 );
-			positions.push_back( pos1 );
-			positions.push_back( pos0 );
-			positions.push_back( pos1 );
-			positions.push_back( pos2 );
-			positions.push_back( pos3 );
+TriMesh MeshHelper::createIcosahedron( uint32_t division, uint32_t flags, MeshBounds *bounds )
+{
+	// Each division doubles the edge frequency
+	division = math<uint32_t>::clamp( division, 1, kMaxIcosahedronDivision );
+	return createGeosphere( 1 << ( division - 1 ), flags, bounds );
+}
 
-			texCoords.push_back( texCoord2 );
-			texCoords.push_back( texCoord1 );
-			texCoords.push_back( texCoord0 );
-			texCoords.push_back( texCoord1 );
-			texCoords.push_back( texCoord2 );
-			texCoords.push_back( texCoord3 );
+bool MeshHelper::createIcosahedron( MeshBuilder &builder, uint32_t division, MeshBounds *bounds )
+{
+	division = math<uint32_t>::clamp( division, 1, kMaxIcosahedronDivision );
+	return createGeosphere( builder, 1 << ( division - 1 ), bounds );
+}
 
-			for ( uint32_t i = 0; i < 6; ++i ) {
-				indices.push_back( index * 6 + i );
-				normals.push_back( norm0 );
-			}
-		}
+TriMesh MeshHelper::createRing( const Vec2i &resolution, float ratio, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( createRing( builder, resolution, ratio, bounds ) ) {
+		applyFlags( mesh, flags );
 	}
+	return mesh;
+}
 
-	TriMesh mesh = MeshHelper::create( indices, positions, normals, texCoords );
-
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	texCoords.clear();
+bool MeshHelper::createRing( MeshBuilder &builder, const Vec2i &resolution, float ratio, MeshBounds *bounds )
+{
+	if ( !buildRing( builder, resolution, ratio ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = getRingBounds( resolution, ratio );
+	}
+	return true;
+}
 
+TriMesh MeshHelper::createSphere( const Vec2i &resolution, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( createSphere( builder, resolution, bounds ) ) {
+		applyFlags( mesh, flags );
+	}
 	return mesh;
+}
 
+bool MeshHelper::createSphere( MeshBuilder &builder, const Vec2i &resolution, MeshBounds *bounds )
+{
+	if ( !buildSphere( builder, resolution ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = getSphereBounds( resolution );
+	}
+	return true;
 }
 
-TriMesh MeshHelper::createTorus( const Vec2i &resolution, float ratio )
+TriMesh MeshHelper::createSquare( const Vec2i &resolution, uint32_t flags, MeshBounds *bounds )
 {
-	vector<uint32_t> indices;
-	vector<Vec3f> normals;
-	vector<Vec3f> positions;
-	vector<Vec3f> srcNormals;
-	vector<Vec3f> srcPositions;
-	vector<Vec2f> srcTexCoords;
-	vector<Vec2f> texCoords;
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( createSquare( builder, resolution, bounds ) ) {
+		applyFlags( mesh, flags );
+	}
+	return mesh;
+}
 
-	float pi			= (float)M_PI;
-	float delta			= ( 2.0f * pi ) / (float)resolution.y;
-	float step			= ( 2.0f * pi ) / (float)resolution.x;
-	float ud			= 1.0f / (float)resolution.y;
-	float vd			= 1.0f / (float)resolution.x;
-
-	float outerRadius	= 0.5f / (1.0f + ratio);
-	float innerRadius	= outerRadius * ratio;
-	
-	int32_t p			= 0;
-	float v				= 0.0f;
-	for ( float phi = 0.0f; p < resolution.x; ++p, v += vd, phi += step ) {
-		float cosPhi = math<float>::cos( phi - pi );
-		float sinPhi = math<float>::sin( phi - pi );
-
-		int32_t t = 0;
-		float u = 0.0f;
-		for ( float theta = 0.0f; t < resolution.y; ++t, u += ud, theta += delta ) {
-			float cosTheta = math<float>::cos( theta );
-			float sinTheta = math<float>::sin( theta );
-
-			float rct	= outerRadius + innerRadius * cosTheta;
-			float x		= cosPhi * rct;
-			float y		= sinPhi * rct;
-			float z		= sinTheta * innerRadius;
-			
-			Vec3f normal( -cosTheta * cosTheta, sinPhi * cosTheta, sinTheta );
-			Vec3f position( x, y, z );
-			Vec2f texCoord( u, v );
-
-			positions.push_back( position );
-			normals.push_back( normal );
-			texCoords.push_back( texCoord );
-		}
-	}
-
-	for ( p = 0; p < resolution.x; ++p ) {
-		int32_t a = ( p + 0 ) * resolution.y;
-		int32_t b = ( p + 1 >= resolution.x ? 0 : p + 1 ) * resolution.y;
-
-		for ( int32_t t = 0; t < resolution.y; ++t ) {
-			int32_t n = t + 1 >= resolution.y ? 0 : t + 1;
-
-			uint32_t index0 = (uint32_t)( a + t );
-			uint32_t index1 = (uint32_t)( a + n );
-			uint32_t index2 = (uint32_t)( b + t );
-			uint32_t index3 = (uint32_t)( b + n );
-
-			indices.push_back( index0 );
-			indices.push_back( index2 );
-			indices.push_back( index1 );
-			indices.push_back( index1 );
-			indices.push_back( index2 );
-			indices.push_back( index3 );
-		}
-	}
-
-	TriMesh mesh = MeshHelper::create( indices, positions, normals, texCoords );
-
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	srcNormals.clear();
-	srcPositions.clear();
-	srcTexCoords.clear();
-	texCoords.clear();
+bool MeshHelper::createSquare( MeshBuilder &builder, const Vec2i &resolution, MeshBounds *bounds )
+{
+	if ( !buildSquare( builder, resolution ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = getSquareBounds( resolution );
+	}
+	return true;
+}
 
+TriMesh MeshHelper::createTorus( const Vec2i &resolution, float ratio, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( createTorus( builder, resolution, ratio, bounds ) ) {
+		applyFlags( mesh, flags );
+	}
 	return mesh;
 }
 
-TriMesh MeshHelper::subdivide( vector<uint32_t> &indices, const vector<Vec3f> &positions, 
-	const vector<Vec3f> &normals, const vector<Vec2f> &texCoords, uint32_t division, bool normalize )
-{
-	TriMesh mesh = create( indices, positions, normals, texCoords );
-	return subdivide( mesh, division, normalize );
-}
-
-TriMesh MeshHelper::subdivide( const ci::TriMesh &triMesh, uint32_t division, bool normalize )
-{
-	if ( division <= 1 || triMesh.getNumIndices() == 0 || triMesh.getNumVertices() == 0 ) {
-		return triMesh;
-	}
-
-	vector<uint32_t> indices	= triMesh.getIndices();
-	vector<Vec3f> normals		= triMesh.getNormals();
-	vector<Vec3f> positions		= triMesh.getVertices();
-	vector<Vec2f> texCoords		= triMesh.getTexCoords();
-
-	vector<uint32_t> indicesBuffer( indices );
-	indices.clear();
-	indices.reserve( indicesBuffer.size() * 4 );
- 
-	uint32_t index0;
-	uint32_t index1;
-	uint32_t index2;
-	uint32_t index3;
-	uint32_t index4;
-	uint32_t index5;
-	for ( vector<uint32_t>::const_iterator iter = indicesBuffer.begin(); iter != indicesBuffer.end(); ) {
-		index0 = *iter;
-		++iter;
-		index1 = *iter;
-		++iter;
-		index2 = *iter;
-		++iter;
-
-		if ( normalize ) {
-			index3 = positions.size();
-			positions.push_back( positions.at( index0 ).lerp( 0.5f, positions.at( index1 ) ).normalized() * 0.5f );
-			index4 = positions.size();
-			positions.push_back( positions.at( index1 ).lerp( 0.5f, positions.at( index2 ) ).normalized() * 0.5f );
-			index5 = positions.size();
-			positions.push_back( positions.at( index2 ).lerp( 0.5f, positions.at( index0 ) ).normalized() * 0.5f );
-		} else {
-			index3 = positions.size(); 
-			positions.push_back( positions.at( index0 ).lerp( 0.5f, positions.at( index1 ) ) );
-			index4 = positions.size();
-			positions.push_back( positions.at( index1 ).lerp( 0.5f, positions.at( index2 ) ) );
-			index5 = positions.size();
-			positions.push_back( positions.at( index2 ).lerp( 0.5f, positions.at( index0 ) ) );
-		}
-	
-		if ( !normals.empty() ) {
-			normals.push_back( normals.at( index0 ).lerp( 0.5f, normals.at( index1 ) ) );
-			normals.push_back( normals.at( index1 ).lerp( 0.5f, normals.at( index2 ) ) );
-			normals.push_back( normals.at( index2 ).lerp( 0.5f, normals.at( index0 ) ) );
-		}
-
-		if ( !texCoords.empty() ) {
-			texCoords.push_back( texCoords.at( index0 ).lerp( 0.5f, texCoords.at( index1 ) ) );
-			texCoords.push_back( texCoords.at( index1 ).lerp( 0.5f, texCoords.at( index2 ) ) );
-			texCoords.push_back( texCoords.at( index2 ).lerp( 0.5f, texCoords.at( index0 ) ) );
-		}
-
-		indices.push_back( index0 ); 
-		indices.push_back( index3 ); 
-		indices.push_back( index5 );
-		
-		indices.push_back( index3 ); 
-		indices.push_back( index1 );
-		indices.push_back( index4 );
-		
-		indices.push_back( index5 ); 
-		indices.push_back( index4 ); 
-		indices.push_back( index2 );
-		
-		indices.push_back( index3 ); 
-		indices.push_back( index4 ); 
-		indices.push_back( index5 );
-	}
-
-	ci::TriMesh mesh = create( indices, positions, normals, texCoords );
-	
-	indices.clear();
-	normals.clear();
-	positions.clear();
-	texCoords.clear();
-
-	return subdivide( mesh, division - 1, normalize );
+bool MeshHelper::createTorus( MeshBuilder &builder, const Vec2i &resolution, float ratio, MeshBounds *bounds )
+{
+	if ( !buildTorus( builder, resolution, ratio ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = getTorusBounds( resolution, ratio );
+	}
+	return true;
+}
+
+MeshBounds MeshHelper::getCubeBounds( const Vec3i &resolution )
+{
+	if ( queryCube( resolution ).getNumVertices() == 0 ) {
+		return MeshBounds();
+	}
+	Vec3f extent = Vec3f::one() * 0.5f;
+	return MeshBounds( -extent, extent, Vec3f::zero(), extent.length() );
+}
+
+MeshBounds MeshHelper::getCylinderBounds( const Vec2i &resolution, float topRadius, float baseRadius )
+{
+	if ( queryCylinder( resolution, false, false ).getNumVertices() == 0 ) {
+		return MeshBounds();
+	}
+
+	// The smallest sphere through both rims is centered on the axis where 
+	// they are equally far, or on the wider rim if that one holds both
+	float top		= topRadius * topRadius;
+	float base		= baseRadius * baseRadius;
+	float center	= math<float>::clamp( ( top - base ) * 0.5f, -0.5f, 0.5f );
+	float radius	= math<float>::sqrt( math<float>::max( top + ( 0.5f - center ) * ( 0.5f - center ), 
+		base + ( 0.5f + center ) * ( 0.5f + center ) ) );
+	float extent	= math<float>::max( math<float>::abs( topRadius ), math<float>::abs( baseRadius ) );
+	return MeshBounds( Vec3f( -extent, -0.5f, -extent ), Vec3f( extent, 0.5f, extent ), Vec3f( 0.0f, center, 0.0f ), radius );
+}
+
+MeshBounds MeshHelper::getGeosphereBounds()
+{
+	Vec3f extent = Vec3f::one() * 0.5f;
+	return MeshBounds( -extent, extent, Vec3f::zero(), 0.5f );
+}
+
+MeshBounds MeshHelper::getRingBounds( const Vec2i &resolution, float ratio )
+{
+	if ( queryRing( resolution, ratio ).getNumVertices() == 0 ) {
+		return MeshBounds();
+	}
+
+	// The inner edge sits at |ratio|, which may be outside the unit rim
+	float radius = math<float>::max( math<float>::abs( ratio ), 1.0f );
+	return MeshBounds( Vec3f( -radius, -radius, 0.0f ), Vec3f( radius, radius, 0.0f ), Vec3f::zero(), radius );
+}
+
+MeshBounds MeshHelper::getSphereBounds( const Vec2i &resolution )
+{
+	if ( querySphere( resolution ).getNumVertices() == 0 ) {
+		return MeshBounds();
+	}
+	return MeshBounds( -Vec3f::one(), Vec3f::one(), Vec3f::zero(), 1.0f );
+}
+
+MeshBounds MeshHelper::getSquareBounds( const Vec2i &resolution )
+{
+	if ( querySquare( resolution ).getNumVertices() == 0 ) {
+		return MeshBounds();
+	}
+	Vec3f extent( 0.5f, 0.5f, 0.0f );
+	return MeshBounds( -extent, extent, Vec3f::zero(), extent.length() );
+}
+
+MeshBounds MeshHelper::getTorusBounds( const Vec2i &resolution, float ratio )
+{
+	if ( queryTorus( resolution ).getNumVertices() == 0 ) {
+		return MeshBounds();
+	}
+
+	// The ring and tube radii always add up to 0.5
+	float innerRadius = math<float>::abs( 0.5f * ratio / ( 1.0f + ratio ) );
+	return MeshBounds( Vec3f( -0.5f, -0.5f, -innerRadius ), Vec3f( 0.5f, 0.5f, innerRadius ), Vec3f::zero(), 0.5f );
+}
+
+// Closes the level of \a chain that starts at \a firstIndex.
+static void addLodLevel( LodChain &chain, size_t firstIndex, float error, uint32_t flags )
+{
+	vector<uint32_t> &indices	= chain.getMesh().getIndices();
+	size_t numVertices			= chain.getMesh().getNumVertices();
+	if ( ( flags & MeshHelper::OPTIMIZE_VERTEX_CACHE ) != 0 && indices.size() > firstIndex ) {
+		MeshHelper::optimizeVertexCache( &indices[ firstIndex ], indices.size() - firstIndex, numVertices );
+	}
+
+	LodLevel level;
+	level.mRange.mBaseVertex	= 0;
+	level.mRange.mFirstIndex	= (uint32_t)firstIndex;
+	level.mRange.mNumIndices	= (uint32_t)( indices.size() - firstIndex );
+	level.mRange.mNumVertices	= (uint32_t)numVertices;
+	level.mError				= error;
+	chain.getLevels().push_back( level );
+}
+
+/*! Fills in the geomorph data of \a chain. A vertex dropped after level L lies 
+	on an edge of level L + 1 between two of its level L neighbors, and its parent 
+	is that edge's midpoint. This only reads the indices, so it suits any chain 
+	whose coarser levels take every other lattice line. */
+static void addLodParents( LodChain &chain )
+{
+	const vector<uint32_t> &indices		= chain.getMesh().getIndices();
+	const vector<Vec3f> &positions		= chain.getMesh().getVertices();
+	const vector<LodLevel> &levels		= chain.getLevels();
+	vector<Vec3f> &parents				= chain.getParentPositions();
+	vector<uint8_t> &vertexLevels		= chain.getVertexLevels();
+	parents = positions;
+	vertexLevels.assign( positions.size(), 0 );
+	for ( size_t level = 1; level < levels.size(); ++level ) {
+		const DrawRange &range = levels[ level ].mRange;
+		for ( size_t i = range.mFirstIndex; i < range.mFirstIndex + range.mNumIndices; ++i ) {
+			vertexLevels[ indices[ i ] ] = (uint8_t)level;
+		}
+	}
+
+	vector<uint64_t> edges;
+	vector<uint64_t> links;
+	for ( size_t level = 0; level + 1 < levels.size(); ++level ) {
+		const DrawRange &fine	= levels[ level ].mRange;
+		const DrawRange &coarse	= levels[ level + 1 ].mRange;
+		edges.clear();
+		for ( size_t i = coarse.mFirstIndex; i < coarse.mFirstIndex + coarse.mNumIndices; ++i ) {
+			uint64_t a = indices[ i ];
+			uint64_t b = indices[ i - i % 3 + ( i + 1 ) % 3 ];
+			edges.push_back( a < b ? ( a << 32 ) | b : ( b << 32 ) | a );
+		}
+		sort( edges.begin(), edges.end() );
+
+		// Link each vertex dropped here to its neighbors which are kept
+		links.clear();
+		for ( size_t i = fine.mFirstIndex; i < fine.mFirstIndex + fine.mNumIndices; ++i ) {
+			uint32_t v = indices[ i ];
+			if ( vertexLevels[ v ] != level ) {
+				continue;
+			}
+			for ( size_t k = 1; k < 3; ++k ) {
+				uint32_t u = indices[ i - i % 3 + ( i + k ) % 3 ];
+				if ( vertexLevels[ u ] > level ) {
+					links.push_back( ( (uint64_t)v << 32 ) | u );
+				}
+			}
+		}
+		sort( links.begin(), links.end() );
+		links.erase( unique( links.begin(), links.end() ), links.end() );
+
+		// Where a vertex's kept neighbors span more than one coarse edge, 
+		// as across a quad's diagonal, the nearest midpoint is its own edge
+		for ( size_t i = 0; i < links.size(); ) {
+			uint32_t v	= (uint32_t)( links[ i ] >> 32 );
+			size_t j	= i;
+			while ( j < links.size() && ( links[ j ] >> 32 ) == v ) {
+				++j;
+			}
+			float nearest = numeric_limits<float>::max();
+			for ( size_t m = i; m < j; ++m ) {
+				for ( size_t n = m + 1; n < j; ++n ) {
+					uint64_t a = links[ m ] & 0xFFFFFFFF;
+					uint64_t b = links[ n ] & 0xFFFFFFFF;
+					if ( !binary_search( edges.begin(), edges.end(), a < b ? ( a << 32 ) | b : ( b << 32 ) | a ) ) {
+						continue;
+					}
+					Vec3f midpoint	= positions[ (size_t)a ].lerp( 0.5f, positions[ (size_t)b ] );
+					float distance	= midpoint.distanceSquared( positions[ v ] );
+					if ( distance < nearest ) {
+						nearest			= distance;
+						parents[ v ]	= midpoint;
+					}
+				}
+			}
+			i = j;
+		}
+	}
+}
+
+// Returns how far the triangles from \a firstIndex on fall inside a 
+// sphere of \a radius at the origin, measured at their planes.
+static float calcSphereLodError( const TriMesh &mesh, size_t firstIndex, float radius )
+{
+	const vector<uint32_t> &indices	= mesh.getIndices();
+	const vector<Vec3f> &positions	= mesh.getVertices();
+	float error = 0.0f;
+	for ( size_t i = firstIndex; i + 2 < indices.size(); i += 3 ) {
+		const Vec3f &a	= positions[ indices[ i + 0 ] ];
+		Vec3f normal	= ( positions[ indices[ i + 1 ] ] - a ).cross( positions[ indices[ i + 2 ] ] - a );
+		float length	= normal.length();
+		if ( length > 0.0f ) {
+			error = math<float>::max( error, radius - math<float>::abs( normal.dot( a ) ) / length );
+		}
+	}
+	return error;
+}
+
+LodChain MeshHelper::createCylinderLodChain( const Vec2i &resolution, float topRadius, float baseRadius, 
+	bool closeTop, bool closeBase, uint32_t numLevels, uint32_t flags )
+{
+	LodChain chain;
+	chain.getMesh() = createCylinder( resolution, topRadius, baseRadius, closeTop, closeBase, flags & ATTRIB_ALL );
+	if ( chain.getMesh().getNumIndices() == 0 ) {
+		return chain;
+	}
+
+	// Rows are straight, so they are only halved while they can be
+	vector<uint32_t> &indices	= chain.getMesh().getIndices();
+	float radius				= math<float>::max( math<float>::abs( topRadius ), math<float>::abs( baseRadius ) );
+	uint32_t stride				= (uint32_t)resolution.x + 1;
+	uint32_t top				= (uint32_t)( resolution.y + 1 ) * stride;
+	uint32_t base				= top + ( closeTop ? (uint32_t)resolution.x + 1 : 0 );
+	uint32_t rowStep			= 1;
+	for ( uint32_t level = 0, step = 1; level < numLevels; ++level, step *= 2 ) {
+		int32_t numSegments = resolution.x / (int32_t)step;
+		if ( level > 0 ) {
+			if ( resolution.x % (int32_t)step != 0 || numSegments < 3 ) {
+				break;
+			}
+			if ( resolution.y % (int32_t)( rowStep * 2 ) == 0 ) {
+				rowStep *= 2;
+			}
+		}
+		int32_t numRows	= resolution.y / (int32_t)rowStep;
+		size_t first	= level > 0 ? indices.size() : 0;
+
+		// The sides end on their closing column, while each cap's rim wraps
+		if ( level > 0 ) {
+			for ( int32_t t = 0; closeTop && t < numSegments; ++t ) {
+				uint32_t n = (uint32_t)( t + 1 >= numSegments ? 0 : t + 1 ) * step;
+				indices.push_back( top );
+				indices.push_back( top + 1 + n );
+				indices.push_back( top + 1 + (uint32_t)t * step );
+			}
+			for ( int32_t p = 0; p < numRows; ++p ) {
+				uint32_t a = (uint32_t)p * rowStep * stride;
+				uint32_t b = (uint32_t)( p + 1 ) * rowStep * stride;
+				for ( int32_t t = 0; t < numSegments; ++t ) {
+					uint32_t c = (uint32_t)t * step;
+					uint32_t n = (uint32_t)( t + 1 ) * step;
+					uint32_t triangles[ 6 ] = { a + c, b + c, a + n, a + n, b + c, b + n };
+					indices.insert( indices.end(), triangles, triangles + 6 );
+				}
+			}
+			for ( int32_t t = 0; closeBase && t < numSegments; ++t ) {
+				uint32_t n = (uint32_t)( t + 1 >= numSegments ? 0 : t + 1 ) * step;
+				indices.push_back( base );
+				indices.push_back( base + 1 + n );
+				indices.push_back( base + 1 + (uint32_t)t * step );
+			}
+		}
+
+		float error = radius * ( 1.0f - math<float>::cos( (float)M_PI / (float)numSegments ) );
+		addLodLevel( chain, first, error, flags );
+	}
+	if ( ( flags & ATTRIB_PARENT_POSITION ) != 0 ) {
+		addLodParents( chain );
+	}
+	return chain;
+}
+
+LodChain MeshHelper::createGeosphereLodChain( uint32_t frequency, uint32_t numLevels, uint32_t flags )
+{
+	LodChain chain;
+	chain.getMesh() = createGeosphere( frequency, flags & ATTRIB_ALL );
+	if ( chain.getMesh().getNumVertices() == 0 ) {
+		return chain;
+	}
+
+	int32_t edgeIds[ 12 ][ 12 ];
+	uint32_t edgeCorners[ 30 ][ 2 ];
+	numberGeosphereEdges( edgeIds, edgeCorners );
+
+	// Coarse lattice points are every step-th point of each face's lattice
+	vector<uint32_t> &indices	= chain.getMesh().getIndices();
+	uint32_t n					= math<uint32_t>::max( frequency, 1 );
+	vector<uint32_t> lattice( ( n + 1 ) * ( n + 2 ) / 2 );
+	vector<uint32_t> rows( n + 2 );
+	for ( uint32_t j = 0; j <= n; ++j ) {
+		rows[ j + 1 ] = rows[ j ] + n - j + 1;
+	}
+
+	for ( uint32_t level = 0, step = 1; level < numLevels; ++level, step *= 2 ) {
+		if ( level > 0 && n % step != 0 ) {
+			break;
+		}
+		uint32_t numSegments	= n / step;
+		size_t first			= level > 0 ? indices.size() : 0;
+
+		for ( uint32_t f = 0; level > 0 && f < 20; ++f ) {
+			getGeosphereLattice( edgeIds, n, f, &lattice[ 0 ] );
+			for ( uint32_t j = 0; j < numSegments; ++j ) {
+				const uint32_t *bottom	= &lattice[ rows[ j * step ] ];
+				const uint32_t *top		= &lattice[ rows[ ( j + 1 ) * step ] ];
+				for ( uint32_t i = 0; i + j < numSegments; ++i ) {
+					indices.push_back( bottom[ i * step ] );
+					indices.push_back( bottom[ ( i + 1 ) * step ] );
+					indices.push_back( top[ i * step ] );
+					if ( i + j + 1 < numSegments ) {
+						indices.push_back( bottom[ ( i + 1 ) * step ] );
+						indices.push_back( top[ ( i + 1 ) * step ] );
+						indices.push_back( top[ i * step ] );
+					}
+				}
+			}
+		}
+
+		addLodLevel( chain, first, calcSphereLodError( chain.getMesh(), first, 0.5f ), flags );
+	}
+	if ( ( flags & ATTRIB_PARENT_POSITION ) != 0 ) {
+		addLodParents( chain );
+	}
+	return chain;
+}
+
+LodChain MeshHelper::createSphereLodChain( const Vec2i &resolution, uint32_t numLevels, uint32_t flags )
+{
+	LodChain chain;
+	chain.getMesh() = createSphere( resolution, flags & ATTRIB_ALL );
+	if ( chain.getMesh().getNumIndices() == 0 ) {
+		return chain;
+	}
+
+	// Coarse quads take every step-th line, ending on the closing column
+	vector<uint32_t> &indices	= chain.getMesh().getIndices();
+	uint32_t stride				= (uint32_t)resolution.x + 1;
+	for ( uint32_t level = 0, step = 1; level < numLevels; ++level, step *= 2 ) {
+		Vec2i lod( resolution.x / (int32_t)step, resolution.y / (int32_t)step );
+		if ( level > 0 && ( resolution.x % (int32_t)step != 0 || resolution.y % (int32_t)step != 0 || 
+			lod.x < 3 || lod.y < 2 ) ) {
+			break;
+		}
+		size_t first = level > 0 ? indices.size() : 0;
+
+		for ( int32_t p = 0; level > 0 && p < lod.y; ++p ) {
+			uint32_t a = (uint32_t)p * step * stride;
+			uint32_t b = (uint32_t)( p + 1 ) * step * stride;
+			for ( int32_t t = 0; t < lod.x; ++t ) {
+				uint32_t c = (uint32_t)t * step;
+				uint32_t n = (uint32_t)( t + 1 ) * step;
+				uint32_t triangles[ 6 ] = { a + c, b + c, a + n, a + n, b + c, b + n };
+				indices.insert( indices.end(), triangles, triangles + 6 );
+			}
+		}
+
+		addLodLevel( chain, first, calcSphereLodError( chain.getMesh(), first, 1.0f ), flags );
+	}
+	if ( ( flags & ATTRIB_PARENT_POSITION ) != 0 ) {
+		addLodParents( chain );
+	}
+	return chain;
+}
+
+LodChain MeshHelper::createTorusLodChain( const Vec2i &resolution, float ratio, uint32_t numLevels, uint32_t flags )
+{
+	LodChain chain;
+	chain.getMesh() = createTorus( resolution, ratio, flags & ATTRIB_ALL );
+	if ( chain.getMesh().getNumIndices() == 0 ) {
+		return chain;
+	}
+
+	vector<uint32_t> &indices	= chain.getMesh().getIndices();
+	float outerRadius			= 0.5f / ( 1.0f + ratio );
+	float innerRadius			= outerRadius * ratio;
+	uint32_t stride				= (uint32_t)resolution.y + 1;
+	for ( uint32_t level = 0, step = 1; level < numLevels; ++level, step *= 2 ) {
+		Vec2i lod( resolution.x / (int32_t)step, resolution.y / (int32_t)step );
+		if ( level > 0 && ( resolution.x % (int32_t)step != 0 || resolution.y % (int32_t)step != 0 || 
+			lod.x < 3 || lod.y < 3 ) ) {
+			break;
+		}
+		size_t first = level > 0 ? indices.size() : 0;
+
+		for ( int32_t p = 0; level > 0 && p < lod.x; ++p ) {
+			uint32_t a = (uint32_t)p * step * stride;
+			uint32_t b = (uint32_t)( p + 1 ) * step * stride;
+			for ( int32_t t = 0; t < lod.y; ++t ) {
+				uint32_t c = (uint32_t)t * step;
+				uint32_t n = (uint32_t)( t + 1 ) * step;
+				uint32_t triangles[ 6 ] = { a + c, b + c, a + n, a + n, b + c, b + n };
+				indices.insert( indices.end(), triangles, triangles + 6 );
+			}
+		}
+
+		// Chords fall short of both the ring and the tube
+		float error = ( outerRadius + innerRadius ) * ( 1.0f - math<float>::cos( (float)M_PI / (float)lod.x ) ) + 
+			innerRadius * ( 1.0f - math<float>::cos( (float)M_PI / (float)lod.y ) );
+		addLodLevel( chain, first, error, flags );
+	}
+	if ( ( flags & ATTRIB_PARENT_POSITION ) != 0 ) {
+		addLodParents( chain );
+	}
+	return chain;
+}
+
+MeshSize MeshHelper::queryCircle( const Vec2i &resolution )
+{
+	return queryRing( resolution, 0.0f );
+}
+
+MeshSize MeshHelper::queryCube( const Vec3i &resolution )
+{
+	MeshSize front	= querySquare( Vec2i( resolution.x, resolution.y ) );
+	MeshSize left	= querySquare( Vec2i( resolution.z, resolution.y ) );
+	MeshSize top	= querySquare( Vec2i( resolution.x, resolution.z ) );
+	return MeshSize( 
+		( front.getNumVertices() + left.getNumVertices() + top.getNumVertices() ) * 2, 
+		( front.getNumIndices() + left.getNumIndices() + top.getNumIndices() ) * 2 
+		);
+}
+
+MeshSize MeshHelper::queryCylinder( const Vec2i &resolution, bool closeTop, bool closeBase )
+{
+	if ( resolution.x <= 0 || resolution.y <= 0 ) {
+		return MeshSize();
+	}
+
+	// Each cap repeats the rim, plus a center vertex, so it can have its own normal
+	MeshSize sides	= queryParametric( resolution, PARAMETRIC_WRAP_U );
+	size_t numCaps	= ( closeTop ? 1 : 0 ) + ( closeBase ? 1 : 0 );
+	return MeshSize( 
+		sides.getNumVertices() + numCaps * (size_t)( resolution.x + 1 ), 
+		sides.getNumIndices() + numCaps * (size_t)resolution.x * 3 
+		);
+}
+
+MeshSize MeshHelper::queryGeosphere( uint32_t frequency )
+{
+	if ( frequency > kMaxGeosphereFrequency ) {
+		return MeshSize();
+	}
+	size_t n = (size_t)math<uint32_t>::max( frequency, 1 );
+	return MeshSize( 10 * n * n + 2, 60 * n * n );
+}
+
+MeshSize MeshHelper::queryIcosahedron( uint32_t division )
+{
+	division = math<uint32_t>::clamp( division, 1, kMaxIcosahedronDivision );
+	return queryGeosphere( 1 << ( division - 1 ) );
+}
+
+MeshSize MeshHelper::queryParametric( const Vec2i &resolution, uint32_t wrap )
+{
+	if ( resolution.x <= 0 || resolution.y <= 0 ) {
+		return MeshSize();
+	}
+	size_t numColumns	= getNumLatticeLines( resolution.x, wrap, PARAMETRIC_WRAP_U );
+	size_t numRows		= getNumLatticeLines( resolution.y, wrap, PARAMETRIC_WRAP_V );
+	return MeshSize( numColumns * numRows, (size_t)resolution.x * (size_t)resolution.y * 6 );
+}
+
+MeshSize MeshHelper::queryRing( const Vec2i &resolution, float ratio )
+{
+	if ( resolution.x <= 0 || resolution.y <= 0 ) {
+		return MeshSize();
+	}
+
+	size_t numVertices	= (size_t)resolution.x * (size_t)( resolution.y + 1 );
+	size_t numIndices	= (size_t)resolution.x * (size_t)resolution.y * 6;
+
+	// A circle shares one center vertex and drops the 
+	// degenerate half of its innermost quads
+	if ( ratio <= 0.0f ) {
+		numVertices	-= (size_t)resolution.x - 1;
+		numIndices	-= (size_t)resolution.x * 3;
+	}
+	return MeshSize( numVertices, numIndices );
+}
+
+MeshSize MeshHelper::querySphere( const Vec2i &resolution )
+{
+	if ( resolution.x <= 0 || resolution.y <= 0 ) {
+		return MeshSize();
+	}
+	return queryParametric( resolution, PARAMETRIC_WRAP_U );
+}
+
+MeshSize MeshHelper::querySquare( const Vec2i &resolution )
+{
+	if ( resolution.x <= 0 || resolution.y <= 0 ) {
+		return MeshSize();
+	}
+	return MeshSize( (size_t)( resolution.x + 1 ) * (size_t)( resolution.y + 1 ), (size_t)resolution.x * (size_t)resolution.y * 6 );
+}
+
+MeshSize MeshHelper::queryTorus( const Vec2i &resolution )
+{
+	if ( resolution.x <= 0 || resolution.y <= 0 ) {
+		return MeshSize();
+	}
+	return queryParametric( Vec2i( resolution.y, resolution.x ), PARAMETRIC_WRAP_U | PARAMETRIC_WRAP_V );
+}
+
+// Returns the vertex count of a subdivided mesh with \a numEdges unique 
+// edges, computed from the closed form: every level adds one vertex per 
+// edge, splits every edge in two and adds three interior edges per triangle.
+static size_t countSubdividedVertices( size_t numVertices, size_t numEdges, size_t numTriangles, uint32_t levels )
+{
+	for ( uint32_t i = 0; i < levels; ++i ) {
+		numVertices		+= numEdges;
+		numEdges		= numEdges * 2 + numTriangles * 3;
+		numTriangles	*= 4;
+	}
+	return numVertices;
+}
+
+/*! Fixed set of worker threads for data-parallel passes. The calling 
+	thread acts as worker zero, so a pool of one thread runs everything 
+	inline without starting any threads. */
+class WorkerPool
+{
+public:
+	explicit WorkerPool( size_t numThreads )
+		: mGeneration( 0 ), mNumTasks( 0 ), mPending( 0 ), mQuit( false )
+	{
+		numThreads = math<size_t>::max( numThreads, 1 );
+		for ( size_t i = 1; i < numThreads; ++i ) {
+			mThreads.push_back( shared_ptr<thread>( new thread( &WorkerPool::work, this, i ) ) );
+		}
+	}
+
+	~WorkerPool()
+	{
+		{
+			lock_guard<mutex> lock( mMutex );
+			mQuit = true;
+		}
+		mWake.notify_all();
+		for ( vector<shared_ptr<thread> >::iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter ) {
+			( *iter )->join();
+		}
+	}
+
+	size_t			getNumThreads() const { return mThreads.size() + 1; }
+
+	//! Runs \a fn( task ) for every task in [0, \a numTasks) and waits for all of them.
+	void			run( size_t numTasks, const function<void( size_t )> &fn )
+	{
+		if ( mThreads.empty() || numTasks <= 1 ) {
+			for ( size_t i = 0; i < numTasks; ++i ) {
+				fn( i );
+			}
+			return;
+		}
+		{
+			lock_guard<mutex> lock( mMutex );
+			mTask		= fn;
+			mNumTasks	= numTasks;
+			mPending	= mThreads.size();
+			++mGeneration;
+		}
+		mWake.notify_all();
+		runTasks( 0 );
+
+		unique_lock<mutex> lock( mMutex );
+		while ( mPending > 0 ) {
+			mDone.wait( lock );
+		}
+		mTask = function<void( size_t )>();
+	}
+
+	/*! Splits [0, \a count) into contiguous ranges of at least \a grain items, 
+		at most one per thread. Returns the range boundaries. */
+	vector<size_t>	split( size_t count, size_t grain ) const
+	{
+		size_t numRanges = math<size_t>::min( getNumThreads(), math<size_t>::max( count / math<size_t>::max( grain, 1 ), 1 ) );
+		vector<size_t> bounds( numRanges + 1 );
+		for ( size_t i = 0; i <= numRanges; ++i ) {
+			bounds[ i ] = (size_t)( (uint64_t)count * i / numRanges );
+		}
+		return bounds;
+	}
+private:
+	void			runTasks( size_t worker )
+	{
+		for ( size_t i = worker; i < mNumTasks; i += getNumThreads() ) {
+			mTask( i );
+		}
+	}
+
+	void			work( size_t worker )
+	{
+		size_t generation = 0;
+		while ( true ) {
+			{
+				unique_lock<mutex> lock( mMutex );
+				while ( !mQuit && mGeneration == generation ) {
+					mWake.wait( lock );
+				}
+				if ( mQuit ) {
+					return;
+				}
+				generation = mGeneration;
+			}
+			runTasks( worker );
+			{
+				lock_guard<mutex> lock( mMutex );
+				--mPending;
+			}
+			mDone.notify_one();
+		}
+	}
+
+	condition_variable				mDone;
+	size_t							mGeneration;
+	mutex							mMutex;
+	size_t							mNumTasks;
+	size_t							mPending;
+	bool							mQuit;
+	function<void( size_t )>		mTask;
+	vector<shared_ptr<thread> >		mThreads;
+	condition_variable				mWake;
+};
+
+void MeshHelper::runRows( size_t numRows, size_t rowSize, uint32_t numThreads, 
+	const function<void( size_t, size_t )> &fn )
+{
+	if ( numThreads == 0 ) {
+		numThreads = math<uint32_t>::max( thread::hardware_concurrency(), 1 );
+	}
+	if ( numRows * rowSize < 65536 ) {
+		numThreads = 1;
+	}
+
+	// Each range is a contiguous run of rows, so threads 
+	// write separate stretches of vertices and indices
+	WorkerPool pool( numThreads );
+	vector<size_t> ranges = pool.split( numRows, math<size_t>::max( 16384 / math<size_t>::max( rowSize, 1 ), 1 ) );
+	pool.run( ranges.size() - 1, [ & ]( size_t r )
+	{
+		fn( ranges[ r ], ranges[ r + 1 ] );
+	} );
+}
+
+/*! Sorted edge table for a triangle list. Every corner's outgoing edge 
+	is bucketed by its lower vertex index, then sorted within the bucket 
+	by its upper vertex index, so each unique edge gets a deterministic 
+	rank without hashing. The table is built with a stable parallel 
+	counting sort, so ranks do not depend on the number of threads. */
+class EdgeTable
+{
+public:
+	void build( WorkerPool &pool, const uint32_t *indices, size_t numTriangles, size_t numVertices )
+	{
+		static const size_t grain = 4096;
+
+		size_t numCorners = numTriangles * 3;
+		mBuckets.resize( numVertices + 1 );
+		mEntries.resize( numCorners );
+		mCornerEdges.resize( numCorners );
+
+		// Count each range of corners into its own histogram
+		vector<size_t> cornerRanges = pool.split( numCorners, grain );
+		size_t numCornerRanges = cornerRanges.size() - 1;
+		mHistograms.assign( numCornerRanges * numVertices, 0 );
+		vector<uint8_t> valid( numCornerRanges, 1 );
+		pool.run( numCornerRanges, [ & ]( size_t range )
+		{
+			uint32_t *histogram = &mHistograms[ range * numVertices ];
+			for ( size_t c = cornerRanges[ range ]; c < cornerRanges[ range + 1 ]; ++c ) {
+				uint32_t a = indices[ c ];
+				uint32_t b = indices[ next( c ) ];
+				if ( a >= numVertices || b >= numVertices ) {
+					valid[ range ] = 0;
+					return;
+				}
+				++histogram[ math<uint32_t>::min( a, b ) ];
+			}
+		} );
+		if ( find( valid.begin(), valid.end(), 0 ) != valid.end() ) {
+			throw out_of_range( "MeshHelper::subdivide: index out of range" );
+		}
+
+		// Turn the histograms into per-range write cursors, in range 
+		// order, which keeps the sort stable
+		uint32_t offset = 0;
+		for ( size_t a = 0; a < numVertices; ++a ) {
+			mBuckets[ a ] = offset;
+			for ( size_t range = 0; range < numCornerRanges; ++range ) {
+				uint32_t count = mHistograms[ range * numVertices + a ];
+				mHistograms[ range * numVertices + a ] = offset;
+				offset += count;
+			}
+		}
+		mBuckets[ numVertices ] = offset;
+
+		// Scatter, keyed by (upper vertex, corner)
+		pool.run( numCornerRanges, [ & ]( size_t range )
+		{
+			uint32_t *cursors = &mHistograms[ range * numVertices ];
+			for ( size_t c = cornerRanges[ range ]; c < cornerRanges[ range + 1 ]; ++c ) {
+				uint32_t a = indices[ c ];
+				uint32_t b = indices[ next( c ) ];
+				uint64_t key = ( (uint64_t)math<uint32_t>::max( a, b ) << 32 ) | (uint64_t)c;
+				mEntries[ cursors[ math<uint32_t>::min( a, b ) ]++ ] = key;
+			}
+		} );
+
+		// Sort each bucket and count its unique edges
+		mVertexRanges = pool.split( numVertices, grain );
+		size_t numVertexRanges = mVertexRanges.size() - 1;
+		mRangeEdges.assign( numVertexRanges + 1, 0 );
+		pool.run( numVertexRanges, [ & ]( size_t range )
+		{
+			uint32_t numEdges = 0;
+			for ( size_t a = mVertexRanges[ range ]; a < mVertexRanges[ range + 1 ]; ++a ) {
+				vector<uint64_t>::iterator first	= mEntries.begin() + mBuckets[ a ];
+				vector<uint64_t>::iterator last		= mEntries.begin() + mBuckets[ a + 1 ];
+				sort( first, last );
+
+				uint64_t upper = ~(uint64_t)0;
+				for ( vector<uint64_t>::iterator iter = first; iter != last; ++iter ) {
+					if ( ( *iter >> 32 ) != upper ) {
+						upper = *iter >> 32;
+						++numEdges;
+					}
+				}
+			}
+			mRangeEdges[ range + 1 ] = numEdges;
+		} );
+		for ( size_t range = 0; range < numVertexRanges; ++range ) {
+			mRangeEdges[ range + 1 ] += mRangeEdges[ range ];
+		}
+		mNumEdges = mRangeEdges[ numVertexRanges ];
+
+		// Rank every corner's edge in (lower, upper) vertex order
+		forEachCorner( pool, [ & ]( uint32_t edge, size_t corner )
+		{
+			mCornerEdges[ corner ] = edge;
+		} );
+	}
+
+	//! Returns the rank of the edge leaving corner \a c.
+	uint32_t		getCornerEdge( size_t c ) const { return mCornerEdges[ c ]; }
+	uint32_t		getNumEdges() const { return mNumEdges; }
+
+	/*! Calls \a fn( edge, lower, upper ) once for each unique edge, from 
+		multiple threads. Each call owns its edge. */
+	void			forEachEdge( WorkerPool &pool, const function<void( uint32_t, uint32_t, uint32_t )> &fn ) const
+	{
+		pool.run( mVertexRanges.size() - 1, [ & ]( size_t range )
+		{
+			uint32_t edge = mRangeEdges[ range ];
+			for ( size_t a = mVertexRanges[ range ]; a < mVertexRanges[ range + 1 ]; ++a ) {
+				uint64_t upper = ~(uint64_t)0;
+				for ( size_t i = mBuckets[ a ]; i < mBuckets[ a + 1 ]; ++i ) {
+					if ( ( mEntries[ i ] >> 32 ) != upper ) {
+						upper = mEntries[ i ] >> 32;
+						fn( edge, (uint32_t)a, (uint32_t)upper );
+						++edge;
+					}
+				}
+			}
+		} );
+	}
+
+	static size_t	next( size_t c ) { return c % 3 == 2 ? c - 2 : c + 1; }
+private:
+	void			forEachCorner( WorkerPool &pool, const function<void( uint32_t, size_t )> &fn ) const
+	{
+		pool.run( mVertexRanges.size() - 1, [ & ]( size_t range )
+		{
+			uint32_t edge = mRangeEdges[ range ];
+			for ( size_t a = mVertexRanges[ range ]; a < mVertexRanges[ range + 1 ]; ++a ) {
+				uint64_t upper = ~(uint64_t)0;
+				for ( size_t i = mBuckets[ a ]; i < mBuckets[ a + 1 ]; ++i ) {
+					if ( ( mEntries[ i ] >> 32 ) != upper ) {
+						upper = mEntries[ i ] >> 32;
+						++edge;
+					}
+					fn( edge - 1, (size_t)( mEntries[ i ] & 0xFFFFFFFF ) );
+				}
+			}
+		} );
+	}
+
+	vector<uint32_t>	mBuckets;
+	vector<uint32_t>	mCornerEdges;
+	vector<uint64_t>	mEntries;
+	vector<uint32_t>	mHistograms;
+	uint32_t			mNumEdges;
+	vector<uint32_t>	mRangeEdges;
+	vector<size_t>		mVertexRanges;
+};
+
+/*! Subdivides vertex data in place \a levels times. Each unique edge is 
+	split exactly once, with its midpoint appended after the existing 
+	vertices. All buffers are sized up front from the closed-form counts. 
+	Work is split across \a numThreads threads (zero for one per core); 
+	the output is identical for any thread count. If \a parentPositions 
+	is not null, it receives each vertex's position before the last level. */
+static void subdivideBuffers( vector<uint32_t> &indices, vector<Vec3f> &positions, vector<Vec3f> &normals, 
+	vector<Vec2f> &texCoords, uint32_t levels, bool normalize, uint32_t numThreads, vector<Vec3f> *parentPositions )
+{
+	size_t numTriangles	= indices.size() / 3;
+	size_t numVertices	= positions.size();
+	if ( levels == 0 || numTriangles == 0 || numVertices == 0 ) {
+		return;
+	}
+	indices.resize( numTriangles * 3 );
+
+	bool hasNormals		= normals.size() == numVertices;
+	bool hasTexCoords	= texCoords.size() == numVertices;
+	if ( !hasNormals ) {
+		normals.clear();
+	}
+	if ( !hasTexCoords ) {
+		texCoords.clear();
+	}
+
+	// Small meshes aren't worth starting threads for
+	size_t finalTriangles = numTriangles << ( 2 * levels );
+	if ( numThreads == 0 ) {
+		numThreads = math<uint32_t>::max( thread::hardware_concurrency(), 1 );
+	}
+	if ( finalTriangles < 65536 ) {
+		numThreads = 1;
+	}
+	WorkerPool pool( numThreads );
+
+	EdgeTable edges;
+	edges.build( pool, &indices[ 0 ], numTriangles, numVertices );
+
+	size_t maxVertices = countSubdividedVertices( numVertices, edges.getNumEdges(), numTriangles, levels );
+	positions.reserve( maxVertices );
+	if ( hasNormals ) {
+		normals.reserve( maxVertices );
+	}
+	if ( hasTexCoords ) {
+		texCoords.reserve( maxVertices );
+	}
+
+	// Ping-pong between two index buffers, arranged so the last level 
+	// writes into the result
+	vector<uint32_t> result;
+	vector<uint32_t> buffer;
+	result.reserve( finalTriangles * 3 );
+	if ( levels > 1 ) {
+		buffer.reserve( finalTriangles * 3 / 4 );
+	}
+
+	vector<uint32_t> *src = &indices;
+	for ( uint32_t level = 0; level < levels; ++level ) {
+		if ( level > 0 ) {
+			edges.build( pool, &( *src )[ 0 ], numTriangles, numVertices );
+		}
+
+		size_t numEdges = edges.getNumEdges();
+		positions.resize( numVertices + numEdges );
+		if ( hasNormals ) {
+			normals.resize( numVertices + numEdges );
+		}
+		if ( hasTexCoords ) {
+			texCoords.resize( numVertices + numEdges );
+		}
+
+		// The last level's parents are the vertices so far, then the 
+		// midpoints as they are before normalizing
+		Vec3f *parent = 0;
+		if ( parentPositions != 0 && level + 1 == levels ) {
+			parentPositions->assign( positions.begin(), positions.begin() + numVertices );
+			parentPositions->resize( numVertices + numEdges );
+			parent = &( *parentPositions )[ 0 ];
+		}
+
+		// Write one midpoint per edge, always interpolating from the 
+		// lower to the upper vertex so shared edges match exactly
+		Vec3f *pos		= &positions[ 0 ];
+		Vec3f *norm		= hasNormals ? &normals[ 0 ] : 0;
+		Vec2f *texCoord	= hasTexCoords ? &texCoords[ 0 ] : 0;
+		size_t base		= numVertices;
+		edges.forEachEdge( pool, [ & ]( uint32_t edge, uint32_t a, uint32_t b )
+		{
+			size_t i = base + edge;
+			pos[ i ] = pos[ a ].lerp( 0.5f, pos[ b ] );
+			if ( parent != 0 ) {
+				parent[ i ] = pos[ i ];
+			}
+			if ( normalize ) {
+				pos[ i ] = pos[ i ].normalized() * 0.5f;
+			}
+			if ( norm != 0 ) {
+				norm[ i ] = norm[ a ].lerp( 0.5f, norm[ b ] ).normalized();
+			}
+			if ( texCoord != 0 ) {
+				texCoord[ i ] = texCoord[ a ].lerp( 0.5f, texCoord[ b ] );
+			}
+		} );
+
+		vector<uint32_t> *dst = ( levels - 1 - level ) % 2 == 0 ? &result : &buffer;
+		dst->resize( numTriangles * 12 );
+		const uint32_t *in	= &( *src )[ 0 ];
+		uint32_t *out		= &( *dst )[ 0 ];
+		vector<size_t> ranges = pool.split( numTriangles, 4096 );
+		pool.run( ranges.size() - 1, [ & ]( size_t range )
+		{
+			for ( size_t t = ranges[ range ]; t < ranges[ range + 1 ]; ++t ) {
+				const uint32_t *tri	= in + t * 3;
+				uint32_t *quad		= out + t * 12;
+
+				uint32_t index0 = tri[ 0 ];
+				uint32_t index1 = tri[ 1 ];
+				uint32_t index2 = tri[ 2 ];
+				uint32_t index3 = (uint32_t)base + edges.getCornerEdge( t * 3 + 0 );
+				uint32_t index4 = (uint32_t)base + edges.getCornerEdge( t * 3 + 1 );
+				uint32_t index5 = (uint32_t)base + edges.getCornerEdge( t * 3 + 2 );
+
+				quad[ 0 ]	= index0;
+				quad[ 1 ]	= index3;
+				quad[ 2 ]	= index5;
+
+				quad[ 3 ]	= index3;
+				quad[ 4 ]	= index1;
+				quad[ 5 ]	= index4;
+
+				quad[ 6 ]	= index5;
+				quad[ 7 ]	= index4;
+				quad[ 8 ]	= index2;
+
+				quad[ 9 ]	= index3;
+				quad[ 10 ]	= index4;
+				quad[ 11 ]	= index5;
+			}
+		} );
+
+		src				= dst;
+		numVertices		+= numEdges;
+		numTriangles	*= 4;
+	}
+
+	indices.swap( result );
+}
+
+// Gathers \a data through \a order, where new element i is old element order[ i ].
+template<typename T>
+static void permute( vector<T> &data, const vector<uint32_t> &order )
+{
+	vector<T> result( order.size() );
+	for ( size_t i = 0; i < order.size(); ++i ) {
+		result[ i ] = data[ order[ i ] ];
+	}
+	data.swap( result );
+}
+
+// Renames \a indices so vertices are numbered in the order they are first 
+// used, unused ones last. Returns the old vertex for each new one.
+static vector<uint32_t> renumberForFetch( vector<uint32_t> &indices, size_t numVertices )
+{
+	static const uint32_t unused = 0xFFFFFFFF;
+	vector<uint32_t> remap( numVertices, unused );
+	vector<uint32_t> order;
+	order.reserve( numVertices );
+	for ( size_t i = 0; i < indices.size(); ++i ) {
+		uint32_t index = indices[ i ];
+		if ( index >= numVertices ) {
+			throw out_of_range( "MeshHelper::optimizeVertexFetch: index out of range" );
+		}
+		if ( remap[ index ] == unused ) {
+			remap[ index ] = (uint32_t)order.size();
+			order.push_back( index );
+		}
+		indices[ i ] = remap[ index ];
+	}
+	for ( size_t i = 0; i < numVertices && order.size() < numVertices; ++i ) {
+		if ( remap[ i ] == unused ) {
+			order.push_back( (uint32_t)i );
+		}
+	}
+	return order;
+}
+
+// Runs \a flags' passes on \a mesh, renumbering \a extra, another 
+// per-vertex array, along with the mesh's vertices
+template<typename T>
+static void applyFlags( TriMesh &mesh, uint32_t flags, vector<T> &extra )
+{
+	applyFlags( mesh, flags & ~MeshHelper::OPTIMIZE_VERTEX_FETCH );
+	if ( ( flags & MeshHelper::OPTIMIZE_VERTEX_FETCH ) != 0 && mesh.getNumIndices() > 0 ) {
+		vector<uint32_t> order = renumberForFetch( mesh.getIndices(), mesh.getNumVertices() );
+		permute( mesh.getVertices(), order );
+		permute( extra, order );
+		if ( !mesh.getNormals().empty() ) {
+			permute( mesh.getNormals(), order );
+		}
+		if ( !mesh.getTexCoords().empty() ) {
+			permute( mesh.getTexCoords(), order );
+		}
+	}
+}
+
+// Copies the attributes in \a attribs into a new TriMesh.
+static TriMesh copyAttribs( const vector<uint32_t> &indices, const vector<Vec3f> &positions, 
+	const vector<Vec3f> &normals, const vector<Vec2f> &texCoords, uint32_t attribs )
+{
+	TriMesh mesh;
+	mesh.getIndices()	= indices;
+	mesh.getVertices()	= positions;
+	if ( ( attribs & MeshHelper::ATTRIB_NORMAL ) != 0 ) {
+		mesh.getNormals() = normals;
+	}
+	if ( ( attribs & MeshHelper::ATTRIB_TEX_COORD ) != 0 ) {
+		mesh.getTexCoords() = texCoords;
+	}
+	return mesh;
+}
+
+TriMesh MeshHelper::subdivide( vector<uint32_t> &indices, const vector<Vec3f> &positions, 
+	const vector<Vec3f> &normals, const vector<Vec2f> &texCoords, uint32_t division, bool normalize, 
+	uint32_t numThreads, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh = copyAttribs( indices, positions, normals, texCoords, flags );
+	if ( bounds != 0 && !normalize ) {
+		*bounds = computeBounds( mesh );
+	}
+	if ( division > 1 ) {
+		subdivideBuffers( mesh.getIndices(), mesh.getVertices(), mesh.getNormals(), mesh.getTexCoords(), 
+			division - 1, normalize, numThreads, 0 );
+	}
+	applyFlags( mesh, flags );
+	if ( bounds != 0 && normalize ) {
+		*bounds = computeBounds( mesh );
+	}
+	return mesh;
+}
+
+TriMesh MeshHelper::subdivide( vector<uint32_t> &&indices, vector<Vec3f> &&positions, 
+	vector<Vec3f> &&normals, vector<Vec2f> &&texCoords, uint32_t division, bool normalize, 
+	uint32_t numThreads, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh = create( move( indices ), move( positions ), move( normals ), move( texCoords ) );
+
+	// Release unused attributes before subdividing so they are never grown
+	if ( ( flags & ATTRIB_NORMAL ) == 0 ) {
+		vector<Vec3f>().swap( mesh.getNormals() );
+	}
+	if ( ( flags & ATTRIB_TEX_COORD ) == 0 ) {
+		vector<Vec2f>().swap( mesh.getTexCoords() );
+	}
+	if ( bounds != 0 && !normalize ) {
+		*bounds = computeBounds( mesh );
+	}
+	if ( division > 1 ) {
+		subdivideBuffers( mesh.getIndices(), mesh.getVertices(), mesh.getNormals(), mesh.getTexCoords(), 
+			division - 1, normalize, numThreads, 0 );
+	}
+	applyFlags( mesh, flags );
+	if ( bounds != 0 && normalize ) {
+		*bounds = computeBounds( mesh );
+	}
+	return mesh;
+}
+
+TriMesh MeshHelper::subdivide( const ci::TriMesh &triMesh, uint32_t division, bool normalize, uint32_t numThreads, 
+	uint32_t flags, MeshBounds *bounds )
+{
+	if ( bounds != 0 && !normalize ) {
+		*bounds = computeBounds( triMesh );
+	}
+	TriMesh mesh = copyAttribs( triMesh.getIndices(), triMesh.getVertices(), triMesh.getNormals(), 
+		triMesh.getTexCoords(), flags );
+	if ( division > 1 ) {
+		subdivideBuffers( mesh.getIndices(), mesh.getVertices(), mesh.getNormals(), mesh.getTexCoords(), 
+			division - 1, normalize, numThreads, 0 );
+	}
+	applyFlags( mesh, flags );
+	if ( bounds != 0 && normalize ) {
+		*bounds = computeBounds( mesh );
+	}
+	return mesh;
+}
+
+TriMesh MeshHelper::subdivide( const ci::TriMesh &triMesh, vector<Vec3f> &parentPositions, uint32_t division, 
+	bool normalize, uint32_t numThreads, uint32_t flags, MeshBounds *bounds )
+{
+	if ( bounds != 0 && !normalize ) {
+		*bounds = computeBounds( triMesh );
+	}
+	TriMesh mesh = copyAttribs( triMesh.getIndices(), triMesh.getVertices(), triMesh.getNormals(), 
+		triMesh.getTexCoords(), flags );
+	parentPositions = mesh.getVertices();
+	if ( division > 1 ) {
+		subdivideBuffers( mesh.getIndices(), mesh.getVertices(), mesh.getNormals(), mesh.getTexCoords(), 
+			division - 1, normalize, numThreads, &parentPositions );
+	}
+
+	// Renumbering vertices has to move the parents along with them
+	applyFlags( mesh, flags, parentPositions );
+	if ( bounds != 0 && normalize ) {
+		*bounds = computeBounds( mesh );
+	}
+	return mesh;
+}
+
+MeshSize MeshHelper::querySubdivide( const ci::TriMesh &triMesh, uint32_t division )
+{
+	size_t numTriangles	= triMesh.getNumIndices() / 3;
+	size_t numVertices	= triMesh.getNumVertices();
+	if ( division <= 1 || numTriangles == 0 || numVertices == 0 ) {
+		return MeshSize( numVertices, triMesh.getNumIndices() );
+	}
+
+	// Only the unique edge count is needed, so count edges on this thread
+	WorkerPool pool( 1 );
+	EdgeTable edges;
+	edges.build( pool, &triMesh.getIndices()[ 0 ], numTriangles, numVertices );
+
+	uint32_t levels = division - 1;
+	return MeshSize( 
+		countSubdividedVertices( numVertices, edges.getNumEdges(), numTriangles, levels ), 
+		( numTriangles << ( 2 * levels ) ) * 3 
+		);
+}
+
+// Forsyth's linear-speed vertex cache optimization. Vertices are scored by 
+// their position in a simulated LRU cache and by how many triangles still 
+// use them, and the triangle with the highest summed score is emitted next.
+static const size_t	kForsythCacheSize		= 32;
+static const float	kForsythCacheDecayPower	= 1.5f;
+static const float	kForsythLastTriScore	= 0.75f;
+static const float	kForsythValenceScale	= 2.0f;
+static const float	kForsythValencePower	= 0.5f;
+static const size_t	kForsythMaxValence		= 64;
+
+// Returns the score of a vertex at \a cachePosition, or -1 if it is not 
+// cached, with \a numLiveTriangles triangles left to emit.
+static float scoreForsythVertex( int32_t cachePosition, uint32_t numLiveTriangles )
+{
+	struct Table
+	{
+		Table()
+		{
+			for ( size_t i = 0; i < kForsythCacheSize; ++i ) {
+				if ( i < 3 ) {
+					mCache[ i ] = kForsythLastTriScore;
+				} else {
+					float scale	= 1.0f / (float)( kForsythCacheSize - 3 );
+					mCache[ i ]	= math<float>::pow( 1.0f - (float)( i - 3 ) * scale, kForsythCacheDecayPower );
+				}
+			}
+			mValence[ 0 ] = 0.0f;
+			for ( size_t i = 1; i < kForsythMaxValence; ++i ) {
+				mValence[ i ] = kForsythValenceScale * math<float>::pow( (float)i, -kForsythValencePower );
+			}
+		}
+
+		float mCache[ kForsythCacheSize ];
+		float mValence[ kForsythMaxValence ];
+	};
+	static const Table table;
+
+	if ( numLiveTriangles == 0 ) {
+		return -1.0f;
+	}
+	float score = cachePosition >= 0 ? table.mCache[ cachePosition ] : 0.0f;
+	if ( numLiveTriangles < kForsythMaxValence ) {
+		score += table.mValence[ numLiveTriangles ];
+	} else {
+		score += kForsythValenceScale * math<float>::pow( (float)numLiveTriangles, -kForsythValencePower );
+	}
+	return score;
+}
+
+void MeshHelper::optimizeVertexCache( TriMesh &triMesh )
+{
+	vector<uint32_t> &indices = triMesh.getIndices();
+	if ( !indices.empty() ) {
+		optimizeVertexCache( &indices[ 0 ], indices.size(), triMesh.getNumVertices() );
+	}
+}
+
+void MeshHelper::optimizeVertexCache( uint32_t *indices, size_t numIndices, size_t numVertices )
+{
+	size_t numTriangles = numIndices / 3;
+	if ( numTriangles < 2 ) {
+		return;
+	}
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if ( indices[ i ] >= numVertices ) {
+			throw out_of_range( "MeshHelper::optimizeVertexCache: index out of range" );
+		}
+	}
+
+	// List each vertex's triangles. The live ones are kept at the 
+	// front of each list so emitted triangles drop off the end.
+	vector<uint32_t> offsets( numVertices + 1, 0 );
+	vector<uint32_t> numLive( numVertices, 0 );
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		++numLive[ indices[ i ] ];
+	}
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		offsets[ i + 1 ] = offsets[ i ] + numLive[ i ];
+	}
+	vector<uint32_t> triangles( numTriangles * 3 );
+	{
+		vector<uint32_t> cursor( offsets.begin(), offsets.end() - 1 );
+		for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+			triangles[ cursor[ indices[ i ] ]++ ] = (uint32_t)( i / 3 );
+		}
+	}
+
+	vector<int32_t> cachePositions( numVertices, -1 );
+	vector<float> vertexScores( numVertices );
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		vertexScores[ i ] = scoreForsythVertex( -1, numLive[ i ] );
+	}
+
+	vector<uint8_t> emitted( numTriangles, 0 );
+	int32_t best		= -1;
+	float bestScore		= -1.0f;
+	for ( size_t i = 0; i < numTriangles; ++i ) {
+		const uint32_t *triangle = indices + i * 3;
+		float score = vertexScores[ triangle[ 0 ] ] + vertexScores[ triangle[ 1 ] ] + vertexScores[ triangle[ 2 ] ];
+		if ( score > bestScore ) {
+			best		= (int32_t)i;
+			bestScore	= score;
+		}
+	}
+
+	// The cache has room for one triangle more than its size, 
+	// so a new triangle's vertices can be pushed before trimming
+	uint32_t cache[ kForsythCacheSize + 3 ];
+	uint32_t nextCache[ kForsythCacheSize + 3 ];
+	size_t cacheCount	= 0;
+	size_t scan			= 0;
+
+	vector<uint32_t> result( numTriangles * 3 );
+	for ( size_t n = 0; n < numTriangles; ++n ) {
+
+		// With nothing in the cache left to use, start again from the 
+		// first triangle not yet emitted
+		if ( best < 0 ) {
+			while ( emitted[ scan ] != 0 ) {
+				++scan;
+			}
+			best = (int32_t)scan;
+		}
+
+		const uint32_t *triangle = indices + best * 3;
+		result[ n * 3 + 0 ] = triangle[ 0 ];
+		result[ n * 3 + 1 ] = triangle[ 1 ];
+		result[ n * 3 + 2 ] = triangle[ 2 ];
+		emitted[ best ] = 1;
+
+		// Move the triangle out of each of its vertices' live lists
+		for ( size_t k = 0; k < 3; ++k ) {
+			uint32_t v		= triangle[ k ];
+			uint32_t *list	= &triangles[ offsets[ v ] ];
+			uint32_t last	= numLive[ v ] - 1;
+			for ( uint32_t j = 0; j <= last; ++j ) {
+				if ( list[ j ] == (uint32_t)best ) {
+					swap( list[ j ], list[ last ] );
+					break;
+				}
+			}
+			--numLive[ v ];
+		}
+
+		// Push the triangle's vertices to the front of the cache
+		size_t nextCount = 0;
+		for ( size_t k = 0; k < 3; ++k ) {
+			uint32_t v = triangle[ k ];
+			if ( find( nextCache, nextCache + nextCount, v ) == nextCache + nextCount ) {
+				nextCache[ nextCount++ ] = v;
+			}
+		}
+		for ( size_t i = 0; i < cacheCount; ++i ) {
+			uint32_t v = cache[ i ];
+			if ( find( nextCache, nextCache + nextCount, v ) == nextCache + nextCount ) {
+				nextCache[ nextCount++ ] = v;
+			}
+		}
+
+		// Rescore everything that moved, including vertices pushed out
+		for ( size_t i = 0; i < nextCount; ++i ) {
+			uint32_t v = nextCache[ i ];
+			cachePositions[ v ]	= i < kForsythCacheSize ? (int32_t)i : -1;
+			vertexScores[ v ]	= scoreForsythVertex( cachePositions[ v ], numLive[ v ] );
+		}
+
+		best		= -1;
+		bestScore	= -1.0f;
+		for ( size_t i = 0; i < nextCount; ++i ) {
+			uint32_t v				= nextCache[ i ];
+			const uint32_t *list	= &triangles[ offsets[ v ] ];
+			for ( uint32_t j = 0; j < numLive[ v ]; ++j ) {
+				uint32_t t					= list[ j ];
+				const uint32_t *neighbor	= indices + t * 3;
+				float score = vertexScores[ neighbor[ 0 ] ] + vertexScores[ neighbor[ 1 ] ] + vertexScores[ neighbor[ 2 ] ];
+				if ( score > bestScore ) {
+					best		= (int32_t)t;
+					bestScore	= score;
+				}
+			}
+		}
+
+		cacheCount = math<size_t>::min( nextCount, kForsythCacheSize );
+		copy( nextCache, nextCache + cacheCount, cache );
+	}
+
+	copy( result.begin(), result.end(), indices );
+}
+
+float MeshHelper::calcAcmr( const TriMesh &triMesh, uint32_t cacheSize )
+{
+	if ( triMesh.getIndices().empty() ) {
+		return 0.0f;
+	}
+	return calcAcmr( &triMesh.getIndices()[ 0 ], triMesh.getNumIndices(), triMesh.getNumVertices(), cacheSize );
+}
+
+/*! Simulated FIFO post-transform cache. Each vertex remembers when it was 
+	last transformed, so hits never reorder the cache and a reset is free. */
+class FifoCache
+{
+public:
+	FifoCache( size_t numVertices, uint32_t cacheSize )
+		: mCacheSize( cacheSize ), mTime( cacheSize + 1 ), mTimestamps( numVertices, 0 )
+	{
+	}
+
+	//! Returns how many of \a triangle's vertices missed the cache, and adds them to it.
+	uint32_t add( const uint32_t *triangle )
+	{
+		uint32_t misses = 0;
+		for ( size_t k = 0; k < 3; ++k ) {
+			size_t &timestamp = mTimestamps[ triangle[ k ] ];
+			if ( mTime - timestamp > mCacheSize ) {
+				timestamp = mTime++;
+				++misses;
+			}
+		}
+		return misses;
+	}
+
+	//! Empties the cache.
+	void reset()
+	{
+		mTime += mCacheSize + 1;
+	}
+private:
+	size_t			mCacheSize;
+	size_t			mTime;
+	vector<size_t>	mTimestamps;
+};
+
+float MeshHelper::calcAcmr( const uint32_t *indices, size_t numIndices, size_t numVertices, uint32_t cacheSize )
+{
+	size_t numTriangles = numIndices / 3;
+	if ( numTriangles == 0 ) {
+		return 0.0f;
+	}
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if ( indices[ i ] >= numVertices ) {
+			throw out_of_range( "MeshHelper::calcAcmr: index out of range" );
+		}
+	}
+
+	FifoCache cache( numVertices, cacheSize );
+	size_t misses = 0;
+	for ( size_t i = 0; i < numTriangles; ++i ) {
+		misses += cache.add( indices + i * 3 );
+	}
+	return (float)misses / (float)numTriangles;
+}
+
+void MeshHelper::optimizeVertexFetch( TriMesh &triMesh )
+{
+	vector<uint32_t> &indices	= triMesh.getIndices();
+	size_t numIndices			= indices.size();
+	size_t numVertices			= triMesh.getNumVertices();
+	if ( numIndices == 0 || numVertices == 0 ) {
+		return;
+	}
+
+	vector<uint32_t> order = renumberForFetch( indices, numVertices );
+	permute( triMesh.getVertices(), order );
+	if ( triMesh.getNormals().size() == numVertices ) {
+		permute( triMesh.getNormals(), order );
+	}
+	if ( triMesh.getTexCoords().size() == numVertices ) {
+		permute( triMesh.getTexCoords(), order );
+	}
+}
+
+void MeshHelper::optimizeOverdraw( TriMesh &triMesh, float threshold, uint32_t cacheSize )
+{
+	vector<uint32_t> &indices			= triMesh.getIndices();
+	const vector<Vec3f> &positions		= triMesh.getVertices();
+	size_t numTriangles					= indices.size() / 3;
+	size_t numVertices					= positions.size();
+	if ( numTriangles < 2 ) {
+		return;
+	}
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if ( indices[ i ] >= numVertices ) {
+			throw out_of_range( "MeshHelper::optimizeOverdraw: index out of range" );
+		}
+	}
+
+	// A triangle whose vertices all miss the cache starts a new patch, 
+	// which can be moved without costing any cache hits
+	FifoCache cache( numVertices, cacheSize );
+	vector<size_t> hard;
+	for ( size_t i = 0; i < numTriangles; ++i ) {
+		if ( cache.add( &indices[ i * 3 ] ) == 3 || i == 0 ) {
+			hard.push_back( i );
+		}
+	}
+	hard.push_back( numTriangles );
+
+	// Split each patch further wherever its ACMR so far is within 
+	// threshold of the whole patch's, so clusters stay cache friendly
+	vector<size_t> clusters;
+	threshold = math<float>::max( threshold, 1.0f );
+	for ( size_t c = 0; c + 1 < hard.size(); ++c ) {
+		size_t start	= hard[ c ];
+		size_t end		= hard[ c + 1 ];
+
+		cache.reset();
+		uint32_t misses = 0;
+		for ( size_t i = start; i < end; ++i ) {
+			misses += cache.add( &indices[ i * 3 ] );
+		}
+		float target = threshold * (float)misses / (float)( end - start );
+
+		cache.reset();
+		clusters.push_back( start );
+		uint32_t runningMisses		= 0;
+		uint32_t runningTriangles	= 0;
+		for ( size_t i = start; i < end; ++i ) {
+			runningMisses += cache.add( &indices[ i * 3 ] );
+			++runningTriangles;
+			if ( (float)runningMisses <= target * (float)runningTriangles && i + 1 < end ) {
+				clusters.push_back( i + 1 );
+				cache.reset();
+				runningMisses		= 0;
+				runningTriangles	= 0;
+			}
+		}
+	}
+	clusters.push_back( numTriangles );
+
+	// Clusters far out along their own normal tend to hide the rest of 
+	// the mesh from most directions, so they are drawn first
+	Vec3f meshCentroid	= Vec3f::zero();
+	float meshArea		= 0.0f;
+	size_t numClusters	= clusters.size() - 1;
+	vector<Vec3f> centroids( numClusters, Vec3f::zero() );
+	vector<Vec3f> normals( numClusters, Vec3f::zero() );
+	for ( size_t c = 0; c < numClusters; ++c ) {
+		float area = 0.0f;
+		for ( size_t i = clusters[ c ]; i < clusters[ c + 1 ]; ++i ) {
+			const Vec3f &a		= positions[ indices[ i * 3 + 0 ] ];
+			const Vec3f &b		= positions[ indices[ i * 3 + 1 ] ];
+			const Vec3f &d		= positions[ indices[ i * 3 + 2 ] ];
+			Vec3f normal		= ( b - a ).cross( d - a );
+			float triangleArea	= normal.length();
+			centroids[ c ]		+= ( a + b + d ) * ( triangleArea / 3.0f );
+			normals[ c ]		+= normal;
+			area				+= triangleArea;
+		}
+		meshCentroid	+= centroids[ c ];
+		meshArea		+= area;
+		centroids[ c ]	*= area > 0.0f ? 1.0f / area : 0.0f;
+	}
+	meshCentroid *= meshArea > 0.0f ? 1.0f / meshArea : 0.0f;
+
+	vector<pair<float, uint32_t> > order( numClusters );
+	for ( size_t c = 0; c < numClusters; ++c ) {
+		float length = normals[ c ].length();
+		float key = length > 0.0f ? ( centroids[ c ] - meshCentroid ).dot( normals[ c ] ) / length : 0.0f;
+		order[ c ] = make_pair( -key, (uint32_t)c );
+	}
+	sort( order.begin(), order.end() );
+
+	vector<uint32_t> result;
+	result.reserve( numTriangles * 3 );
+	for ( size_t c = 0; c < numClusters; ++c ) {
+		uint32_t cluster = order[ c ].second;
+		result.insert( result.end(), indices.begin() + clusters[ cluster ] * 3, indices.begin() + clusters[ cluster + 1 ] * 3 );
+	}
+	copy( result.begin(), result.end(), indices.begin() );
+}
+
+float MeshHelper::calcOverdraw( const TriMesh &triMesh, uint32_t resolution )
+{
+	const vector<uint32_t> &indices		= triMesh.getIndices();
+	const vector<Vec3f> &positions		= triMesh.getVertices();
+	size_t numTriangles					= indices.size() / 3;
+	size_t numVertices					= positions.size();
+	if ( numTriangles == 0 || resolution == 0 ) {
+		return 0.0f;
+	}
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if ( indices[ i ] >= numVertices ) {
+			throw out_of_range( "MeshHelper::calcOverdraw: index out of range" );
+		}
+	}
+
+	// Fit the mesh into the unit cube, keeping its proportions
+	Vec3f minimum = positions[ 0 ];
+	Vec3f maximum = positions[ 0 ];
+	for ( size_t i = 1; i < numVertices; ++i ) {
+		for ( size_t k = 0; k < 3; ++k ) {
+			minimum[ k ] = math<float>::min( minimum[ k ], positions[ i ][ k ] );
+			maximum[ k ] = math<float>::max( maximum[ k ], positions[ i ][ k ] );
+		}
+	}
+	Vec3f extent	= maximum - minimum;
+	float size		= math<float>::max( extent.x, math<float>::max( extent.y, extent.z ) );
+	float scale		= size > 0.0f ? 1.0f / size : 0.0f;
+
+	// Render the mesh from both ends of each axis, culling back faces, 
+	// and count fragments which pass the depth test against pixels covered
+	float fResolution		= (float)resolution;
+	size_t numCovered		= 0;
+	size_t numShaded		= 0;
+	vector<float> depths( resolution * resolution );
+	for ( size_t view = 0; view < 6; ++view ) {
+		size_t axis		= view / 2;
+		float side		= view % 2 == 0 ? 1.0f : -1.0f;
+		size_t right	= ( axis + 1 ) % 3;
+		size_t up		= ( axis + 2 ) % 3;
+		fill( depths.begin(), depths.end(), numeric_limits<float>::max() );
+
+		for ( size_t i = 0; i < numTriangles; ++i ) {
+			Vec3f corners[ 3 ];
+			for ( size_t k = 0; k < 3; ++k ) {
+				Vec3f position	= ( positions[ indices[ i * 3 + k ] ] - minimum ) * scale;
+				corners[ k ].x	= ( side > 0.0f ? position[ right ] : 1.0f - position[ right ] ) * fResolution;
+				corners[ k ].y	= position[ up ] * fResolution;
+				corners[ k ].z	= side > 0.0f ? 1.0f - position[ axis ] : position[ axis ];
+			}
+
+			float area = ( corners[ 1 ].x - corners[ 0 ].x ) * ( corners[ 2 ].y - corners[ 0 ].y ) - 
+				( corners[ 2 ].x - corners[ 0 ].x ) * ( corners[ 1 ].y - corners[ 0 ].y );
+			if ( area <= 0.0f ) {
+				continue;
+			}
+
+			int32_t x0 = math<int32_t>::max( (int32_t)math<float>::floor( math<float>::min( corners[ 0 ].x, math<float>::min( corners[ 1 ].x, corners[ 2 ].x ) ) ), 0 );
+			int32_t x1 = math<int32_t>::min( (int32_t)math<float>::ceil( math<float>::max( corners[ 0 ].x, math<float>::max( corners[ 1 ].x, corners[ 2 ].x ) ) ), (int32_t)resolution - 1 );
+			int32_t y0 = math<int32_t>::max( (int32_t)math<float>::floor( math<float>::min( corners[ 0 ].y, math<float>::min( corners[ 1 ].y, corners[ 2 ].y ) ) ), 0 );
+			int32_t y1 = math<int32_t>::min( (int32_t)math<float>::ceil( math<float>::max( corners[ 0 ].y, math<float>::max( corners[ 1 ].y, corners[ 2 ].y ) ) ), (int32_t)resolution - 1 );
+
+			float invArea = 1.0f / area;
+			for ( int32_t y = y0; y <= y1; ++y ) {
+				for ( int32_t x = x0; x <= x1; ++x ) {
+					float px = (float)x + 0.5f;
+					float py = (float)y + 0.5f;
+
+					// Barycentric weights from the edge functions
+					float w0 = ( corners[ 2 ].x - corners[ 1 ].x ) * ( py - corners[ 1 ].y ) - ( corners[ 2 ].y - corners[ 1 ].y ) * ( px - corners[ 1 ].x );
+					float w1 = ( corners[ 0 ].x - corners[ 2 ].x ) * ( py - corners[ 2 ].y ) - ( corners[ 0 ].y - corners[ 2 ].y ) * ( px - corners[ 2 ].x );
+					float w2 = area - w0 - w1;
+					if ( w0 < 0.0f || w1 < 0.0f || w2 < 0.0f ) {
+						continue;
+					}
+
+					float depth = ( w0 * corners[ 0 ].z + w1 * corners[ 1 ].z + w2 * corners[ 2 ].z ) * invArea;
+					float &stored = depths[ (size_t)y * resolution + (size_t)x ];
+					if ( depth < stored ) {
+						if ( stored == numeric_limits<float>::max() ) {
+							++numCovered;
+						}
+						stored = depth;
+						++numShaded;
+					}
+				}
+			}
+		}
+	}
+
+	return numCovered > 0 ? (float)numShaded / (float)numCovered : 0.0f;
+}
+
+// Converts triangle list \a indices to strips separated by the largest 
+// value of T. Strips are grown greedily across shared edges, starting 
+// from the first triangle not yet used, so lattices written row by row 
+// become one strip per row.
+template<typename T>
+static vector<T> stripifyIndices( const vector<T> &indices )
+{
+	static const T restart		= numeric_limits<T>::max();
+	size_t numTriangles			= indices.size() / 3;
+	vector<T> strips;
+	if ( numTriangles == 0 ) {
+		return strips;
+	}
+
+	size_t numVertices = 0;
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if ( indices[ i ] == restart ) {
+			throw out_of_range( "MeshHelper::stripify: index is the restart index" );
+		}
+		numVertices = math<size_t>::max( numVertices, (size_t)indices[ i ] + 1 );
+	}
+
+	// List each vertex's triangles
+	vector<uint32_t> offsets( numVertices + 1, 0 );
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		++offsets[ indices[ i ] + 1 ];
+	}
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		offsets[ i + 1 ] += offsets[ i ];
+	}
+	vector<uint32_t> triangles( numTriangles * 3 );
+	{
+		vector<uint32_t> cursor( offsets.begin(), offsets.end() - 1 );
+		for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+			triangles[ cursor[ indices[ i ] ]++ ] = (uint32_t)( i / 3 );
+		}
+	}
+
+	// Returns the third vertex of an unused triangle with the directed 
+	// edge \a from to \a to, marking it used if \a take is set
+	vector<uint8_t> used( numTriangles, 0 );
+	auto findNext = [ & ]( T from, T to, bool take, T &third ) -> bool
+	{
+		for ( uint32_t j = offsets[ from ]; j < offsets[ from + 1 ]; ++j ) {
+			uint32_t t = triangles[ j ];
+			if ( used[ t ] != 0 ) {
+				continue;
+			}
+			const T *triangle = &indices[ t * 3 ];
+			for ( size_t k = 0; k < 3; ++k ) {
+				if ( triangle[ k ] == from && triangle[ ( k + 1 ) % 3 ] == to ) {
+					third = triangle[ ( k + 2 ) % 3 ];
+					if ( take ) {
+						used[ t ] = 1;
+					}
+					return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	strips.reserve( numTriangles * 2 );
+	for ( size_t i = 0; i < numTriangles; ++i ) {
+		if ( used[ i ] != 0 ) {
+			continue;
+		}
+		used[ i ] = 1;
+
+		// Start on whichever edge leads somewhere, keeping the winding
+		const T *triangle	= &indices[ i * 3 ];
+		size_t first		= 0;
+		T third				= 0;
+		for ( size_t k = 0; k < 3; ++k ) {
+			if ( findNext( triangle[ ( k + 2 ) % 3 ], triangle[ ( k + 1 ) % 3 ], false, third ) ) {
+				first = k;
+				break;
+			}
+		}
+
+		if ( !strips.empty() ) {
+			strips.push_back( restart );
+		}
+		size_t start = strips.size();
+		strips.push_back( triangle[ first ] );
+		strips.push_back( triangle[ ( first + 1 ) % 3 ] );
+		strips.push_back( triangle[ ( first + 2 ) % 3 ] );
+
+		// Odd triangles in a strip are wound backwards
+		for ( size_t n = strips.size() - start; ; ++n ) {
+			T a = strips[ strips.size() - 2 ];
+			T b = strips[ strips.size() - 1 ];
+			bool even = ( n - 2 ) % 2 == 0;
+			if ( !findNext( even ? a : b, even ? b : a, true, third ) ) {
+				break;
+			}
+			strips.push_back( third );
+		}
+	}
+
+	return strips;
+}
+
+vector<uint32_t> MeshHelper::stripify( const vector<uint32_t> &indices )
+{
+	return stripifyIndices( indices );
+}
+
+vector<uint16_t> MeshHelper::stripify( const vector<uint16_t> &indices )
+{
+	return stripifyIndices( indices );
+}
+
+// Fills in the bounding sphere and normal cone of \a meshlet.
+static void boundMeshlet( Meshlet &meshlet, const MeshletMesh &mesh, const vector<Vec3f> &positions )
+{
+	const uint32_t *vertices	= &mesh.getVertices()[ meshlet.mVertexOffset ];
+	const uint8_t *triangles	= &mesh.getTriangles()[ meshlet.mTriangleOffset * 3 ];
+
+	Vec3f minimum = positions[ vertices[ 0 ] ];
+	Vec3f maximum = minimum;
+	for ( uint32_t i = 1; i < meshlet.mNumVertices; ++i ) {
+		const Vec3f &position = positions[ vertices[ i ] ];
+		for ( size_t k = 0; k < 3; ++k ) {
+			minimum[ k ] = math<float>::min( minimum[ k ], position[ k ] );
+			maximum[ k ] = math<float>::max( maximum[ k ], position[ k ] );
+		}
+	}
+	meshlet.mCenter = ( minimum + maximum ) * 0.5f;
+	meshlet.mRadius = 0.0f;
+	for ( uint32_t i = 0; i < meshlet.mNumVertices; ++i ) {
+		meshlet.mRadius = math<float>::max( meshlet.mRadius, positions[ vertices[ i ] ].distance( meshlet.mCenter ) );
+	}
+
+	vector<Vec3f> normals;
+	normals.reserve( meshlet.mNumTriangles );
+	Vec3f axis = Vec3f::zero();
+	for ( uint32_t i = 0; i < meshlet.mNumTriangles; ++i ) {
+		const Vec3f &a	= positions[ vertices[ triangles[ i * 3 + 0 ] ] ];
+		const Vec3f &b	= positions[ vertices[ triangles[ i * 3 + 1 ] ] ];
+		const Vec3f &c	= positions[ vertices[ triangles[ i * 3 + 2 ] ] ];
+		Vec3f normal	= ( b - a ).cross( c - a );
+		float length	= normal.length();
+		if ( length > 0.0f ) {
+			normals.push_back( normal / length );
+			axis += normals.back();
+		}
+	}
+
+	// The cone cannot cull once its normals spread past 90 degrees
+	meshlet.mConeAxis	= Vec3f::zero();
+	meshlet.mConeCutoff	= 1.0f;
+	float length		= axis.length();
+	if ( length > 0.0f ) {
+		axis /= length;
+		float minDot = 1.0f;
+		for ( vector<Vec3f>::const_iterator iter = normals.begin(); iter != normals.end(); ++iter ) {
+			minDot = math<float>::min( minDot, iter->dot( axis ) );
+		}
+		if ( minDot > 0.0f ) {
+			meshlet.mConeAxis	= axis;
+			meshlet.mConeCutoff	= math<float>::sqrt( 1.0f - minDot * minDot );
+		}
+	}
+}
+
+// Returns how many of \a triangle's distinct vertices have no entry in \a local.
+static uint32_t countNewVertices( const uint32_t *triangle, const vector<uint32_t> &local )
+{
+	uint32_t numNew = 0;
+	for ( size_t k = 0; k < 3; ++k ) {
+		bool repeated = ( k > 0 && triangle[ k ] == triangle[ 0 ] ) || ( k > 1 && triangle[ k ] == triangle[ 1 ] );
+		if ( !repeated && local[ triangle[ k ] ] == 0xFFFFFFFF ) {
+			++numNew;
+		}
+	}
+	return numNew;
+}
+
+MeshletMesh MeshHelper::buildMeshlets( const TriMesh &triMesh, uint32_t maxVertices, uint32_t maxTriangles )
+{
+	MeshletMesh mesh( maxVertices, maxTriangles );
+	maxVertices							= mesh.getMaxVertices();
+	maxTriangles						= mesh.getMaxTriangles();
+	const vector<uint32_t> &indices		= triMesh.getIndices();
+	size_t numTriangles					= indices.size() / 3;
+	size_t numVertices					= triMesh.getNumVertices();
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if ( indices[ i ] >= numVertices ) {
+			throw out_of_range( "MeshHelper::buildMeshlets: index out of range" );
+		}
+	}
+	if ( numTriangles == 0 ) {
+		return mesh;
+	}
+
+	// List each vertex's triangles
+	vector<uint32_t> offsets( numVertices + 1, 0 );
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		++offsets[ indices[ i ] + 1 ];
+	}
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		offsets[ i + 1 ] += offsets[ i ];
+	}
+	vector<uint32_t> triangles( numTriangles * 3 );
+	{
+		vector<uint32_t> cursor( offsets.begin(), offsets.end() - 1 );
+		for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+			triangles[ cursor[ indices[ i ] ]++ ] = (uint32_t)( i / 3 );
+		}
+	}
+
+	// Local index of each vertex in the open meshlet, if it is in it
+	static const uint32_t unused = 0xFFFFFFFF;
+	vector<uint32_t> local( numVertices, unused );
+	vector<uint8_t> emitted( numTriangles, 0 );
+	mesh.getTriangles().reserve( numTriangles * 3 );
+
+	size_t scan = 0;
+	while ( true ) {
+		while ( scan < numTriangles && emitted[ scan ] != 0 ) {
+			++scan;
+		}
+		if ( scan == numTriangles ) {
+			break;
+		}
+
+		Meshlet meshlet;
+		meshlet.mVertexOffset	= (uint32_t)mesh.getVertices().size();
+		meshlet.mNumVertices	= 0;
+		meshlet.mTriangleOffset	= (uint32_t)( mesh.getTriangles().size() / 3 );
+		meshlet.mNumTriangles	= 0;
+
+		int64_t next = (int64_t)scan;
+		while ( next >= 0 ) {
+			const uint32_t *triangle = &indices[ (size_t)next * 3 ];
+			emitted[ (size_t)next ] = 1;
+			for ( size_t k = 0; k < 3; ++k ) {
+				uint32_t v = triangle[ k ];
+				if ( local[ v ] == unused ) {
+					local[ v ] = meshlet.mNumVertices++;
+					mesh.getVertices().push_back( v );
+				}
+				mesh.getTriangles().push_back( (uint8_t)local[ v ] );
+			}
+			++meshlet.mNumTriangles;
+			if ( meshlet.mNumTriangles == maxTriangles ) {
+				break;
+			}
+
+			// Prefer the neighbor adding the fewest new vertices
+			next				= -1;
+			uint32_t bestNew	= 3;
+			const uint32_t *used = &mesh.getVertices()[ meshlet.mVertexOffset ];
+			for ( uint32_t i = 0; i < meshlet.mNumVertices && bestNew > 0; ++i ) {
+				uint32_t v = used[ i ];
+				for ( uint32_t j = offsets[ v ]; j < offsets[ v + 1 ]; ++j ) {
+					uint32_t t = triangles[ j ];
+					if ( emitted[ t ] != 0 ) {
+						continue;
+					}
+					uint32_t numNew = countNewVertices( &indices[ t * 3 ], local );
+					if ( meshlet.mNumVertices + numNew <= maxVertices && ( next < 0 || numNew < bestNew ) ) {
+						next	= t;
+						bestNew	= numNew;
+					}
+				}
+			}
+
+			// Fall back to the next triangle in order while it fits
+			if ( next < 0 ) {
+				while ( scan < numTriangles && emitted[ scan ] != 0 ) {
+					++scan;
+				}
+				if ( scan < numTriangles ) {
+					uint32_t numNew = countNewVertices( &indices[ scan * 3 ], local );
+					if ( meshlet.mNumVertices + numNew <= maxVertices ) {
+						next = (int64_t)scan;
+					}
+				}
+			}
+		}
+
+		const uint32_t *used = &mesh.getVertices()[ meshlet.mVertexOffset ];
+		for ( uint32_t i = 0; i < meshlet.mNumVertices; ++i ) {
+			local[ used[ i ] ] = unused;
+		}
+		mesh.getMeshlets().push_back( meshlet );
+	}
+
+	for ( vector<Meshlet>::iterator iter = mesh.getMeshlets().begin(); iter != mesh.getMeshlets().end(); ++iter ) {
+		boundMeshlet( *iter, mesh, triMesh.getVertices() );
+	}
+
+	return mesh;
+}
+
+// Error quadric of a vertex over its triangles' planes and attributes, as 
+// in Hoppe's attribute metric. The error of a vertex at position p with 
+// attributes a is p'Ap + 2b.p + c + sum( w a^2 - 2a ( g.p + d ) ), over w.
+// Accumulated in double, as the terms of nearly coplanar planes cancel.
+struct Quadric
+{
+	static const size_t kMaxAttribs = 5;
+
+	Quadric()
+	{
+		memset( this, 0, sizeof( Quadric ) );
+	}
+
+	Quadric& operator+=( const Quadric &rhs )
+	{
+		double *lhsValues		= &mA00;
+		const double *rhsValues	= &rhs.mA00;
+		for ( size_t i = 0; i < sizeof( Quadric ) / sizeof( double ); ++i ) {
+			lhsValues[ i ] += rhsValues[ i ];
+		}
+		return *this;
+	}
+
+	//! Adds the plane through \a a, \a b and \a c, weighted by area, with \a numAttribs attributes per corner.
+	void addTriangle( const Vec3f &a, const Vec3f &b, const Vec3f &c, const float *attribsA, const float *attribsB, 
+		const float *attribsC, size_t numAttribs )
+	{
+		Vec3d origin( a.x, a.y, a.z );
+		Vec3d e1		= Vec3d( b.x, b.y, b.z ) - origin;
+		Vec3d e2		= Vec3d( c.x, c.y, c.z ) - origin;
+		Vec3d normal	= e1.cross( e2 );
+		double length2	= normal.lengthSquared();
+		double length	= math<double>::sqrt( length2 );
+		if ( length <= 0.0 ) {
+			return;
+		}
+		double weight	= length * 0.5;
+		Vec3d unit		= normal / length;
+		addTerm( unit, -unit.dot( origin ), weight );
+
+		// Each attribute varies linearly over the triangle, with a gradient in its plane
+		Vec3d gradient1 = e2.cross( normal ) / length2;
+		Vec3d gradient2 = normal.cross( e1 ) / length2;
+		for ( size_t i = 0; i < numAttribs; ++i ) {
+			Vec3d gradient	= gradient1 * (double)( attribsB[ i ] - attribsA[ i ] ) + gradient2 * (double)( attribsC[ i ] - attribsA[ i ] );
+			double offset	= attribsA[ i ] - gradient.dot( origin );
+			addTerm( gradient, offset, weight );
+			mGradients[ i ][ 0 ] += gradient.x * weight;
+			mGradients[ i ][ 1 ] += gradient.y * weight;
+			mGradients[ i ][ 2 ] += gradient.z * weight;
+			mGradients[ i ][ 3 ] += offset * weight;
+		}
+		mWeight += weight;
+	}
+
+	//! Returns the weighted squared error of a vertex at \a p with \a numAttribs \a attribs.
+	double evaluate( const Vec3f &p, const float *attribs, size_t numAttribs ) const
+	{
+		double x		= p.x;
+		double y		= p.y;
+		double z		= p.z;
+		double error	= 
+			mA00 * x * x + mA11 * y * y + mA22 * z * z + 
+			2.0 * ( mA01 * x * y + mA02 * x * z + mA12 * y * z ) + 
+			2.0 * ( mB0 * x + mB1 * y + mB2 * z ) + mC;
+		for ( size_t i = 0; i < numAttribs; ++i ) {
+			const double *g	= mGradients[ i ];
+			double a		= attribs[ i ];
+			error += mWeight * a * a - 2.0 * a * ( g[ 0 ] * x + g[ 1 ] * y + g[ 2 ] * z + g[ 3 ] );
+		}
+		return math<double>::abs( error );
+	}
+
+	// Adds ( n.p + d )^2 times weight.
+	void addTerm( const Vec3d &n, double d, double weight )
+	{
+		mA00 += n.x * n.x * weight;
+		mA11 += n.y * n.y * weight;
+		mA22 += n.z * n.z * weight;
+		mA01 += n.x * n.y * weight;
+		mA02 += n.x * n.z * weight;
+		mA12 += n.y * n.z * weight;
+		mB0 += n.x * d * weight;
+		mB1 += n.y * d * weight;
+		mB2 += n.z * d * weight;
+		mC += d * d * weight;
+	}
+
+	double	mA00, mA11, mA22, mA01, mA02, mA12;
+	double	mB0, mB1, mB2, mC;
+	double	mWeight;
+	double	mGradients[ kMaxAttribs ][ 4 ];
+};
+
+/*! Min-heap of vertices keyed by their collapse cost. Each vertex has at 
+	most one entry, which moves in place when its cost changes, so the heap 
+	never holds stale entries. Four children per node keep sifts shallow. */
+class CollapseHeap
+{
+public:
+	explicit CollapseHeap( size_t numVertices )
+		: mPositions( numVertices, kNone )
+	{
+	}
+
+	bool		isEmpty() const { return mEntries.empty(); }
+	//! Returns the cheapest vertex.
+	uint32_t	getTop() const { return mEntries[ 0 ].mVertex; }
+
+	//! Removes \a vertex, if queued.
+	void remove( uint32_t vertex )
+	{
+		uint32_t position = mPositions[ vertex ];
+		if ( position == kNone ) {
+			return;
+		}
+		mPositions[ vertex ] = kNone;
+		Entry last = mEntries.back();
+		mEntries.pop_back();
+		if ( position < mEntries.size() ) {
+			place( position, last );
+		}
+	}
+
+	//! Queues \a vertex at \a error, or moves it there if already queued.
+	void update( uint32_t vertex, float error )
+	{
+		Entry entry;
+		entry.mError	= error;
+		entry.mVertex	= vertex;
+		uint32_t position = mPositions[ vertex ];
+		if ( position == kNone ) {
+			position = (uint32_t)mEntries.size();
+			mEntries.push_back( entry );
+		}
+		place( position, entry );
+	}
+private:
+	static const uint32_t kNone = 0xFFFFFFFF;
+
+	struct Entry
+	{
+		float		mError;
+		uint32_t	mVertex;
+	};
+
+	// Sifts \a entry up or down from \a position to where it belongs
+	void place( uint32_t position, const Entry &entry )
+	{
+		while ( position > 0 ) {
+			uint32_t parent = ( position - 1 ) / 4;
+			if ( mEntries[ parent ].mError <= entry.mError ) {
+				break;
+			}
+			set( position, mEntries[ parent ] );
+			position = parent;
+		}
+		uint32_t size = (uint32_t)mEntries.size();
+		for ( ; ; ) {
+			uint32_t first = position * 4 + 1;
+			if ( first >= size ) {
+				break;
+			}
+			uint32_t last	= math<uint32_t>::min( first + 4, size );
+			uint32_t child	= first;
+			for ( uint32_t i = first + 1; i < last; ++i ) {
+				if ( mEntries[ i ].mError < mEntries[ child ].mError ) {
+					child = i;
+				}
+			}
+			if ( mEntries[ child ].mError >= entry.mError ) {
+				break;
+			}
+			set( position, mEntries[ child ] );
+			position = child;
+		}
+		set( position, entry );
+	}
+
+	void set( uint32_t position, const Entry &entry )
+	{
+		mEntries[ position ]		= entry;
+		mPositions[ entry.mVertex ]	= position;
+	}
+
+	vector<Entry>		mEntries;
+	vector<uint32_t>	mPositions;
+};
+
+// Collapse target of a vertex, ordered by error and then by edge length 
+// so that flat regions collapse their shortest edges first.
+struct Candidate
+{
+	bool operator<( const Candidate &rhs ) const
+	{
+		return mError != rhs.mError ? mError < rhs.mError : mLength < rhs.mLength;
+	}
+
+	float		mError;
+	float		mLength;
+	uint32_t	mVertex;
+};
+
+TriMesh MeshHelper::simplify( const TriMesh &triMesh, size_t targetTriangles, float maxError, float normalWeight, 
+	float texCoordWeight, float *resultError )
+{
+	const vector<uint32_t> &sourceIndices	= triMesh.getIndices();
+	const vector<Vec3f> &sourcePositions	= triMesh.getVertices();
+	const vector<Vec3f> &sourceNormals		= triMesh.getNormals();
+	const vector<Vec2f> &sourceTexCoords	= triMesh.getTexCoords();
+	size_t numTriangles						= sourceIndices.size() / 3;
+	size_t numVertices						= sourcePositions.size();
+	bool hasNormals							= numVertices > 0 && sourceNormals.size() == numVertices;
+	bool hasTexCoords						= numVertices > 0 && sourceTexCoords.size() == numVertices;
+	if ( resultError != 0 ) {
+		*resultError = 0.0f;
+	}
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if ( sourceIndices[ i ] >= numVertices ) {
+			throw out_of_range( "MeshHelper::simplify: index out of range" );
+		}
+	}
+
+	// Work on a copy scaled to fit the unit cube, so errors are relative to the mesh's size
+	vector<uint32_t> indices( sourceIndices.begin(), sourceIndices.begin() + numTriangles * 3 );
+	vector<Vec3f> positions( sourcePositions );
+	Vec3f minimum = numVertices > 0 ? positions[ 0 ] : Vec3f::zero();
+	Vec3f maximum = minimum;
+	for ( size_t i = 1; i < numVertices; ++i ) {
+		for ( size_t k = 0; k < 3; ++k ) {
+			minimum[ k ] = math<float>::min( minimum[ k ], positions[ i ][ k ] );
+			maximum[ k ] = math<float>::max( maximum[ k ], positions[ i ][ k ] );
+		}
+	}
+	Vec3f extent	= maximum - minimum;
+	float size		= math<float>::max( extent.x, math<float>::max( extent.y, extent.z ) );
+	float scale		= size > 0.0f ? 1.0f / size : 0.0f;
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		positions[ i ] = ( positions[ i ] - minimum ) * scale;
+	}
+
+	size_t numAttribs = 0;
+	vector<float> attribs;
+	if ( hasNormals || hasTexCoords ) {
+		numAttribs = ( hasNormals ? 3 : 0 ) + ( hasTexCoords ? 2 : 0 );
+		attribs.reserve( numVertices * numAttribs );
+		for ( size_t i = 0; i < numVertices; ++i ) {
+			if ( hasNormals ) {
+				attribs.push_back( sourceNormals[ i ].x * normalWeight );
+				attribs.push_back( sourceNormals[ i ].y * normalWeight );
+				attribs.push_back( sourceNormals[ i ].z * normalWeight );
+			}
+			if ( hasTexCoords ) {
+				attribs.push_back( sourceTexCoords[ i ].x * texCoordWeight );
+				attribs.push_back( sourceTexCoords[ i ].y * texCoordWeight );
+			}
+		}
+	}
+	const float *attribData = attribs.empty() ? 0 : &attribs[ 0 ];
+
+	// Lock vertices sharing a position with another vertex (attribute 
+	// seams) and vertices on open edges, so the outline never moves
+	vector<uint32_t> wedges( numVertices );
+	{
+		vector<uint32_t> order( numVertices );
+		for ( size_t i = 0; i < numVertices; ++i ) {
+			order[ i ] = (uint32_t)i;
+		}
+		sort( order.begin(), order.end(), [ & ]( uint32_t a, uint32_t b )
+		{
+			const Vec3f &pa = sourcePositions[ a ];
+			const Vec3f &pb = sourcePositions[ b ];
+			return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z != pb.z ? pa.z < pb.z : a < b;
+		} );
+		for ( size_t i = 0; i < numVertices; ++i ) {
+			bool same = i > 0 && sourcePositions[ order[ i ] ] == sourcePositions[ order[ i - 1 ] ];
+			wedges[ order[ i ] ] = same ? wedges[ order[ i - 1 ] ] : order[ i ];
+		}
+	}
+	vector<uint8_t> locked( numVertices, 0 );
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		if ( wedges[ i ] != i ) {
+			locked[ i ]				= 1;
+			locked[ wedges[ i ] ]	= 1;
+		}
+	}
+	{
+		vector<uint64_t> edges;
+		edges.reserve( numTriangles * 3 );
+		for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+			uint64_t a = wedges[ indices[ i ] ];
+			uint64_t b = wedges[ indices[ i - i % 3 + ( i + 1 ) % 3 ] ];
+			edges.push_back( a < b ? ( a << 32 ) | b : ( b << 32 ) | a );
+		}
+		sort( edges.begin(), edges.end() );
+		for ( size_t i = 0; i < edges.size(); ) {
+			size_t j = i + 1;
+			while ( j < edges.size() && edges[ j ] == edges[ i ] ) {
+				++j;
+			}
+			if ( j - i == 1 ) {
+				uint32_t a = (uint32_t)( edges[ i ] >> 32 );
+				uint32_t b = (uint32_t)( edges[ i ] & 0xFFFFFFFF );
+				locked[ a ] = 1;
+				locked[ b ] = 1;
+			}
+			i = j;
+		}
+		for ( size_t i = 0; i < numVertices; ++i ) {
+			if ( locked[ wedges[ i ] ] != 0 ) {
+				locked[ i ] = 1;
+			}
+		}
+	}
+
+	vector<Quadric> quadrics( numVertices );
+	for ( size_t i = 0; i < numTriangles; ++i ) {
+		const uint32_t *triangle = &indices[ i * 3 ];
+		Quadric quadric;
+		quadric.addTriangle( positions[ triangle[ 0 ] ], positions[ triangle[ 1 ] ], positions[ triangle[ 2 ] ], 
+			attribData + triangle[ 0 ] * numAttribs, attribData + triangle[ 1 ] * numAttribs, 
+			attribData + triangle[ 2 ] * numAttribs, numAttribs );
+		for ( size_t k = 0; k < 3; ++k ) {
+			quadrics[ triangle[ k ] ] += quadric;
+		}
+	}
+
+	// The error of each vertex against its own quadric, which every 
+	// collapse onto it adds, is kept alongside so that costing a 
+	// collapse reads only the source quadric
+	vector<double> selfErrors( numVertices );
+	vector<double> weights( numVertices );
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		selfErrors[ i ]	= quadrics[ i ].evaluate( positions[ i ], attribData + i * numAttribs, numAttribs );
+		weights[ i ]	= quadrics[ i ].mWeight;
+	}
+
+	// Each vertex keeps a linked list of its corners. A collapse moves 
+	// the corners of one vertex to the other by splicing their lists.
+	static const uint32_t none = 0xFFFFFFFF;
+	vector<uint32_t> heads( numVertices, none );
+	vector<uint32_t> tails( numVertices, none );
+	vector<uint32_t> nextCorners( numTriangles * 3, none );
+	for ( size_t i = 0; i < numTriangles * 3; ++i ) {
+		uint32_t v = indices[ i ];
+		if ( heads[ v ] == none ) {
+			heads[ v ] = (uint32_t)i;
+		} else {
+			nextCorners[ tails[ v ] ] = (uint32_t)i;
+		}
+		tails[ v ] = (uint32_t)i;
+	}
+
+	vector<uint8_t> deadTriangles( numTriangles, 0 );
+	vector<uint32_t> neighbors;
+	vector<Candidate> candidates;
+	vector<uint32_t> targets( numVertices, none );
+	vector<float> costs( numVertices, 0.0f );
+	vector<uint32_t> marks( numVertices, 0 );
+	uint32_t pass = 0;
+	CollapseHeap heap( numVertices );
+
+	// A collapse must not fold the surface: the two vertices may only 
+	// share the neighbors across their shared triangles, and no remaining 
+	// triangle may flip or turn too far
+	auto isValid = [ & ]( uint32_t from, uint32_t to ) -> bool
+	{
+		++pass;
+		size_t numShared = 0;
+		for ( uint32_t c = heads[ from ]; c != none; c = nextCorners[ c ] ) {
+			if ( deadTriangles[ c / 3 ] != 0 ) {
+				continue;
+			}
+			const uint32_t *triangle	= &indices[ c - c % 3 ];
+			uint32_t b					= triangle[ ( c + 1 ) % 3 ];
+			uint32_t d					= triangle[ ( c + 2 ) % 3 ];
+			marks[ b ]					= pass;
+			marks[ d ]					= pass;
+			if ( b == to || d == to ) {
+				++numShared;
+				continue;
+			}
+			Vec3f before	= ( positions[ b ] - positions[ from ] ).cross( positions[ d ] - positions[ from ] );
+			Vec3f after		= ( positions[ b ] - positions[ to ] ).cross( positions[ d ] - positions[ to ] );
+			if ( before.dot( after ) <= 0.25f * before.length() * after.length() ) {
+				return false;
+			}
+		}
+		++pass;
+		size_t numCommon = 0;
+		for ( uint32_t c = heads[ to ]; c != none; c = nextCorners[ c ] ) {
+			if ( deadTriangles[ c / 3 ] != 0 ) {
+				continue;
+			}
+			const uint32_t *triangle = &indices[ c - c % 3 ];
+			for ( uint32_t k = 1; k < 3; ++k ) {
+				uint32_t v = triangle[ ( c + k ) % 3 ];
+				if ( marks[ v ] == pass - 1 ) {
+					marks[ v ] = pass;
+					++numCommon;
+				}
+			}
+		}
+		return numCommon <= numShared;
+	};
+
+	// Finds the cheapest valid collapse of a vertex onto one of its 
+	// neighbors and queues it, replacing any earlier entry
+	float limit = maxError * maxError;
+	auto evaluate = [ & ]( uint32_t from )
+	{
+		if ( locked[ from ] != 0 ) {
+			return;
+		}
+		const Quadric &quadric	= quadrics[ from ];
+		const Vec3f &position	= positions[ from ];
+		candidates.clear();
+		for ( uint32_t c = heads[ from ]; c != none; c = nextCorners[ c ] ) {
+			if ( deadTriangles[ c / 3 ] != 0 ) {
+				continue;
+			}
+			// Each neighbor across an edge leaving this corner; interior 
+			// neighbors are reached once from each side
+			uint32_t to		= indices[ c - c % 3 + ( c + 1 ) % 3 ];
+			double weight	= quadric.mWeight + weights[ to ];
+			double error	= quadric.evaluate( positions[ to ], attribData + to * numAttribs, numAttribs ) + selfErrors[ to ];
+			error			= weight > 0.0 ? error / weight : 0.0;
+			if ( error <= limit ) {
+				Candidate candidate;
+				candidate.mError	= (float)error;
+				candidate.mLength	= position.distanceSquared( positions[ to ] );
+				candidate.mVertex	= to;
+				candidates.push_back( candidate );
+			}
+		}
+		sort( candidates.begin(), candidates.end() );
+		vector<Candidate>::const_iterator iter = candidates.begin();
+		while ( iter != candidates.end() && !isValid( from, iter->mVertex ) ) {
+			++iter;
+		}
+
+		if ( iter == candidates.end() ) {
+			targets[ from ] = none;
+			heap.remove( from );
+		} else if ( targets[ from ] != iter->mVertex || costs[ from ] != iter->mError ) {
+			targets[ from ]	= iter->mVertex;
+			costs[ from ]	= iter->mError;
+			heap.update( from, iter->mError );
+		}
+	};
+
+	for ( size_t i = 0; i < numVertices; ++i ) {
+		evaluate( (uint32_t)i );
+	}
+
+	size_t numLive	= numTriangles;
+	float error		= 0.0f;
+	while ( numLive > targetTriangles && !heap.isEmpty() ) {
+		// The neighborhood may have changed since the collapse was queued
+		uint32_t from = heap.getTop();
+		uint32_t to = targets[ from ];
+		if ( !isValid( from, to ) ) {
+			evaluate( from );
+			continue;
+		}
+
+		for ( uint32_t c = heads[ from ]; c != none; c = nextCorners[ c ] ) {
+			if ( deadTriangles[ c / 3 ] != 0 ) {
+				continue;
+			}
+			const uint32_t *triangle = &indices[ c - c % 3 ];
+			if ( triangle[ 0 ] == to || triangle[ 1 ] == to || triangle[ 2 ] == to ) {
+				deadTriangles[ c / 3 ] = 1;
+				--numLive;
+			} else {
+				indices[ c ] = to;
+			}
+		}
+		if ( heads[ from ] != none ) {
+			if ( heads[ to ] == none ) {
+				heads[ to ] = heads[ from ];
+			} else {
+				nextCorners[ tails[ to ] ] = heads[ from ];
+			}
+			tails[ to ] = tails[ from ];
+		}
+		heap.remove( from );
+		quadrics[ to ] += quadrics[ from ];
+		selfErrors[ to ]	= quadrics[ to ].evaluate( positions[ to ], attribData + to * numAttribs, numAttribs );
+		weights[ to ]		= quadrics[ to ].mWeight;
+		error = math<float>::max( error, costs[ from ] );
+
+		// Drop the dead corners from the merged list, then requeue the 
+		// vertex and its neighbors, whose costs involve its quadric
+		uint32_t head = none;
+		uint32_t tail = none;
+		for ( uint32_t c = heads[ to ]; c != none; c = nextCorners[ c ] ) {
+			if ( deadTriangles[ c / 3 ] != 0 ) {
+				continue;
+			}
+			if ( head == none ) {
+				head = c;
+			} else {
+				nextCorners[ tail ] = c;
+			}
+			tail = c;
+		}
+		if ( tail != none ) {
+			nextCorners[ tail ] = none;
+		}
+		heads[ to ] = head;
+		tails[ to ] = tail;
+
+		neighbors.clear();
+		for ( uint32_t c = heads[ to ]; c != none; c = nextCorners[ c ] ) {
+			const uint32_t *triangle = &indices[ c - c % 3 ];
+			neighbors.push_back( triangle[ ( c + 1 ) % 3 ] );
+			neighbors.push_back( triangle[ ( c + 2 ) % 3 ] );
+		}
+		sort( neighbors.begin(), neighbors.end() );
+		neighbors.erase( unique( neighbors.begin(), neighbors.end() ), neighbors.end() );
+		evaluate( to );
+
+		// Other neighbors' queued costs read neither vertex, so only those
+		// aiming at one of them, or with nothing queued, need another look.
+		// Any that became invalid are caught when popped.
+		for ( vector<uint32_t>::const_iterator iter = neighbors.begin(); iter != neighbors.end(); ++iter ) {
+			uint32_t target = targets[ *iter ];
+			if ( target == none || target == from || target == to ) {
+				evaluate( *iter );
+			}
+		}
+	}
+
+	// Keep the live triangles and the vertices they use
+	TriMesh mesh;
+	vector<uint32_t> remap( numVertices, none );
+	for ( size_t i = 0; i < numTriangles; ++i ) {
+		if ( deadTriangles[ i ] != 0 ) {
+			continue;
+		}
+		for ( size_t k = 0; k < 3; ++k ) {
+			uint32_t v = indices[ i * 3 + k ];
+			if ( remap[ v ] == none ) {
+				remap[ v ] = (uint32_t)mesh.getVertices().size();
+				mesh.getVertices().push_back( sourcePositions[ v ] );
+				if ( hasNormals ) {
+					mesh.getNormals().push_back( sourceNormals[ v ] );
+				}
+				if ( hasTexCoords ) {
+					mesh.getTexCoords().push_back( sourceTexCoords[ v ] );
+				}
+			}
+			mesh.getIndices().push_back( remap[ v ] );
+		}
+	}
+
+	if ( resultError != 0 ) {
+		*resultError = math<float>::sqrt( error );
+	}
+	return mesh;
+}
+
+#if defined( MESHHELPER_SSE )
+// Loads four packed Vec3f into x, y and z lanes
+static inline void loadVec3x4( const Vec3f *positions, __m128 &x, __m128 &y, __m128 &z )
+{
+	const float *p	= &positions->x;
+	__m128 a		= _mm_loadu_ps( p );		// x0 y0 z0 x1
+	__m128 b		= _mm_loadu_ps( p + 4 );	// y1 z1 x2 y2
+	__m128 c		= _mm_loadu_ps( p + 8 );	// z2 x3 y3 z3
+	x = _mm_shuffle_ps( a, _mm_shuffle_ps( b, c, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+	y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), 
+		_mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+	z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ), 
+		_mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+}
+
+static inline float horizontalMin( __m128 v )
+{
+	v = _mm_min_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	v = _mm_min_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	return _mm_cvtss_f32( v );
+}
+
+static inline float horizontalMax( __m128 v )
+{
+	v = _mm_max_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	v = _mm_max_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	return _mm_cvtss_f32( v );
+}
+#endif
+
+// Largest squared distance from \a center over \a positions
+static float calcMaxDistanceSquared( const Vec3f *positions, size_t numPositions, const Vec3f &center )
+{
+	size_t i	= 0;
+	float d		= 0.0f;
+#if defined( MESHHELPER_SSE )
+	if ( numPositions >= 4 ) {
+		__m128 cx	= _mm_set1_ps( center.x );
+		__m128 cy	= _mm_set1_ps( center.y );
+		__m128 cz	= _mm_set1_ps( center.z );
+		__m128 dMax	= _mm_setzero_ps();
+		for ( ; i + 4 <= numPositions; i += 4 ) {
+			__m128 x, y, z;
+			loadVec3x4( positions + i, x, y, z );
+			x = _mm_sub_ps( x, cx );
+			y = _mm_sub_ps( y, cy );
+			z = _mm_sub_ps( z, cz );
+			dMax = _mm_max_ps( dMax, _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), 
+				_mm_mul_ps( z, z ) ) );
+		}
+		d = horizontalMax( dMax );
+	}
+#endif
+	for ( ; i < numPositions; ++i ) {
+		d = math<float>::max( d, positions[ i ].distanceSquared( center ) );
+	}
+	return d;
+}
+
+MeshBounds MeshHelper::computeBounds( const TriMesh &triMesh )
+{
+	const vector<Vec3f> &positions = triMesh.getVertices();
+	return positions.empty() ? MeshBounds() : computeBounds( &positions[ 0 ], positions.size() );
+}
+
+MeshBounds MeshHelper::computeBounds( const Vec3f *positions, size_t numPositions )
+{
+	if ( positions == 0 || numPositions == 0 ) {
+		return MeshBounds();
+	}
+
+	// Box
+	Vec3f minimum	= positions[ 0 ];
+	Vec3f maximum	= positions[ 0 ];
+	size_t i		= 0;
+#if defined( MESHHELPER_SSE )
+	if ( numPositions >= 4 ) {
+		__m128 xMin, yMin, zMin;
+		loadVec3x4( positions, xMin, yMin, zMin );
+		__m128 xMax = xMin;
+		__m128 yMax = yMin;
+		__m128 zMax = zMin;
+		for ( i = 4; i + 4 <= numPositions; i += 4 ) {
+			__m128 x, y, z;
+			loadVec3x4( positions + i, x, y, z );
+			xMin = _mm_min_ps( xMin, x );
+			yMin = _mm_min_ps( yMin, y );
+			zMin = _mm_min_ps( zMin, z );
+			xMax = _mm_max_ps( xMax, x );
+			yMax = _mm_max_ps( yMax, y );
+			zMax = _mm_max_ps( zMax, z );
+		}
+		minimum = Vec3f( horizontalMin( xMin ), horizontalMin( yMin ), horizontalMin( zMin ) );
+		maximum = Vec3f( horizontalMax( xMax ), horizontalMax( yMax ), horizontalMax( zMax ) );
+	}
+#endif
+	for ( ; i < numPositions; ++i ) {
+		const Vec3f &p = positions[ i ];
+		minimum = Vec3f( math<float>::min( minimum.x, p.x ), math<float>::min( minimum.y, p.y ), 
+			math<float>::min( minimum.z, p.z ) );
+		maximum = Vec3f( math<float>::max( maximum.x, p.x ), math<float>::max( maximum.y, p.y ), 
+			math<float>::max( maximum.z, p.z ) );
+	}
+
+	// Sphere centered on the box
+	Vec3f boxCenter = ( minimum + maximum ) * 0.5f;
+	float boxRadius = math<float>::sqrt( calcMaxDistanceSquared( positions, numPositions, boxCenter ) );
+
+	// Ritter's sphere, seeded with the box's largest half extent. Points 
+	// outside pull the sphere toward themselves just enough to enclose them.
+	Vec3f extent	= maximum - minimum;
+	Vec3f center	= boxCenter;
+	float radius	= math<float>::max( extent.x, math<float>::max( extent.y, extent.z ) ) * 0.5f;
+	for ( i = 0; i < numPositions; ++i ) {
+		const Vec3f &p	= positions[ i ];
+		float d			= p.distanceSquared( center );
+		if ( d > radius * radius ) {
+			d				= math<float>::sqrt( d );
+			float grown		= ( radius + d ) * 0.5f;
+			center			+= ( p - center ) * ( ( grown - radius ) / d );
+			radius			= grown;
+		}
+	}
+	// Growth is exact in theory; re-measure so rounding never leaves a point out
+	radius = math<float>::sqrt( calcMaxDistanceSquared( positions, numPositions, center ) );
+
+	if ( boxRadius <= radius ) {
+		return MeshBounds( minimum, maximum, boxCenter, boxRadius );
+	}
+	return MeshBounds( minimum, maximum, center, radius );
+}
+
+// atan2( \a y, \a x ) for \a y >= 0, within 1e-5 radians
+static inline float atan2Positive( float y, float x )
+{
+	float absX	= math<float>::abs( x );
+	float high	= math<float>::max( absX, y );
+	float a		= math<float>::min( absX, y ) / math<float>::max( high, 1e-30f );
+	float a2	= a * a;
+	float r		= ( ( ( ( ( -0.01172120f * a2 + 0.05265332f ) * a2 - 0.11643287f ) * a2 + 0.19354346f ) * a2 
+		- 0.33262347f ) * a2 + 0.99997726f ) * a;
+	if ( y > absX ) {
+		r = (float)M_PI * 0.5f - r;
+	}
+	return x < 0.0f ? (float)M_PI - r : r;
+}
+
+#if defined( MESHHELPER_SSE )
+static inline __m128 atan2Positive( __m128 y, __m128 x )
+{
+	__m128 absX		= _mm_andnot_ps( _mm_set1_ps( -0.0f ), x );
+	__m128 high		= _mm_max_ps( absX, y );
+	__m128 a		= _mm_div_ps( _mm_min_ps( absX, y ), _mm_max_ps( high, _mm_set1_ps( 1e-30f ) ) );
+	__m128 a2		= _mm_mul_ps( a, a );
+	__m128 r		= _mm_set1_ps( -0.01172120f );
+	r = _mm_add_ps( _mm_mul_ps( r, a2 ), _mm_set1_ps( 0.05265332f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, a2 ), _mm_set1_ps( -0.11643287f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, a2 ), _mm_set1_ps( 0.19354346f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, a2 ), _mm_set1_ps( -0.33262347f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, a2 ), _mm_set1_ps( 0.99997726f ) );
+	r = _mm_mul_ps( r, a );
+
+	// Unfold from [0, pi / 4] into the half plane
+	__m128 steep	= _mm_cmpgt_ps( y, absX );
+	r = _mm_or_ps( _mm_and_ps( steep, _mm_sub_ps( _mm_set1_ps( (float)M_PI * 0.5f ), r ) ), _mm_andnot_ps( steep, r ) );
+	__m128 back		= _mm_cmplt_ps( x, _mm_setzero_ps() );
+	return _mm_or_ps( _mm_and_ps( back, _mm_sub_ps( _mm_set1_ps( (float)M_PI ), r ) ), _mm_andnot_ps( back, r ) );
+}
+#endif
+
+// Adds the weighted normals of triangles [\a begin, \a end) to \a normals, 
+// which holds vertices [\a offset, \a limit)
+static void accumulateNormals( const uint32_t *indices, size_t begin, size_t end, const Vec3f *positions, 
+	MeshHelper::NormalWeight weight, Vec3f *normals, uint32_t offset, uint32_t limit )
+{
+	normals -= offset;
+	bool angle	= weight == MeshHelper::NORMAL_WEIGHT_ANGLE;
+	size_t i	= begin;
+#if defined( MESHHELPER_SSE )
+	for ( ; i + 4 <= end; i += 4 ) {
+		const uint32_t *t = indices + i * 3;
+		uint32_t high = 0;
+		for ( size_t k = 0; k < 12; ++k ) {
+			high = t[ k ] > high ? t[ k ] : high;
+		}
+		if ( high >= limit ) {
+			throw out_of_range( "MeshHelper::computeNormals: index out of range" );
+		}
+		const Vec3f &a0 = positions[ t[ 0 ] ];
+		const Vec3f &a1 = positions[ t[ 3 ] ];
+		const Vec3f &a2 = positions[ t[ 6 ] ];
+		const Vec3f &a3 = positions[ t[ 9 ] ];
+		const Vec3f &b0 = positions[ t[ 1 ] ];
+		const Vec3f &b1 = positions[ t[ 4 ] ];
+		const Vec3f &b2 = positions[ t[ 7 ] ];
+		const Vec3f &b3 = positions[ t[ 10 ] ];
+		const Vec3f &c0 = positions[ t[ 2 ] ];
+		const Vec3f &c1 = positions[ t[ 5 ] ];
+		const Vec3f &c2 = positions[ t[ 8 ] ];
+		const Vec3f &c3 = positions[ t[ 11 ] ];
+		__m128 ax = _mm_setr_ps( a0.x, a1.x, a2.x, a3.x );
+		__m128 ay = _mm_setr_ps( a0.y, a1.y, a2.y, a3.y );
+		__m128 az = _mm_setr_ps( a0.z, a1.z, a2.z, a3.z );
+		__m128 e1x = _mm_sub_ps( _mm_setr_ps( b0.x, b1.x, b2.x, b3.x ), ax );
+		__m128 e1y = _mm_sub_ps( _mm_setr_ps( b0.y, b1.y, b2.y, b3.y ), ay );
+		__m128 e1z = _mm_sub_ps( _mm_setr_ps( b0.z, b1.z, b2.z, b3.z ), az );
+		__m128 e2x = _mm_sub_ps( _mm_setr_ps( c0.x, c1.x, c2.x, c3.x ), ax );
+		__m128 e2y = _mm_sub_ps( _mm_setr_ps( c0.y, c1.y, c2.y, c3.y ), ay );
+		__m128 e2z = _mm_sub_ps( _mm_setr_ps( c0.z, c1.z, c2.z, c3.z ), az );
+
+		// Twice the area, pointing along the face normal
+		__m128 nx = _mm_sub_ps( _mm_mul_ps( e1y, e2z ), _mm_mul_ps( e1z, e2y ) );
+		__m128 ny = _mm_sub_ps( _mm_mul_ps( e1z, e2x ), _mm_mul_ps( e1x, e2z ) );
+		__m128 nz = _mm_sub_ps( _mm_mul_ps( e1x, e2y ), _mm_mul_ps( e1y, e2x ) );
+
+		float x[ 4 ], y[ 4 ], z[ 4 ];
+		_mm_storeu_ps( x, nx );
+		_mm_storeu_ps( y, ny );
+		_mm_storeu_ps( z, nz );
+		if ( !angle ) {
+			for ( size_t k = 0; k < 4; ++k ) {
+				Vec3f n( x[ k ], y[ k ], z[ k ] );
+				normals[ t[ k * 3 ] ]		+= n;
+				normals[ t[ k * 3 + 1 ] ]	+= n;
+				normals[ t[ k * 3 + 2 ] ]	+= n;
+			}
+			continue;
+		}
+
+		// The angle at each corner is atan2( |n|, dot ) of its two edges, 
+		// as every corner's edges have the same cross product
+		__m128 e3x = _mm_sub_ps( e2x, e1x );
+		__m128 e3y = _mm_sub_ps( e2y, e1y );
+		__m128 e3z = _mm_sub_ps( e2z, e1z );
+		__m128 length = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, nx ), _mm_mul_ps( ny, ny ) ), 
+			_mm_mul_ps( nz, nz ) ) );
+		__m128 d0 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( e1x, e2x ), _mm_mul_ps( e1y, e2y ) ), _mm_mul_ps( e1z, e2z ) );
+		__m128 d1 = _mm_sub_ps( _mm_setzero_ps(), 
+			_mm_add_ps( _mm_add_ps( _mm_mul_ps( e1x, e3x ), _mm_mul_ps( e1y, e3y ) ), _mm_mul_ps( e1z, e3z ) ) );
+		__m128 d2 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( e2x, e3x ), _mm_mul_ps( e2y, e3y ) ), _mm_mul_ps( e2z, e3z ) );
+		__m128 scale = _mm_and_ps( _mm_cmpgt_ps( length, _mm_setzero_ps() ), 
+			_mm_div_ps( _mm_set1_ps( 1.0f ), length ) );
+		float l[ 4 ], w[ 3 ][ 4 ];
+		_mm_storeu_ps( l, scale );
+		_mm_storeu_ps( w[ 0 ], atan2Positive( length, d0 ) );
+		_mm_storeu_ps( w[ 1 ], atan2Positive( length, d1 ) );
+		_mm_storeu_ps( w[ 2 ], atan2Positive( length, d2 ) );
+		for ( size_t k = 0; k < 4; ++k ) {
+			Vec3f n = Vec3f( x[ k ], y[ k ], z[ k ] ) * l[ k ];
+			normals[ t[ k * 3 ] ]		+= n * w[ 0 ][ k ];
+			normals[ t[ k * 3 + 1 ] ]	+= n * w[ 1 ][ k ];
+			normals[ t[ k * 3 + 2 ] ]	+= n * w[ 2 ][ k ];
+		}
+	}
+#endif
+	for ( ; i < end; ++i ) {
+		const uint32_t *t = indices + i * 3;
+		if ( t[ 0 ] >= limit || t[ 1 ] >= limit || t[ 2 ] >= limit ) {
+			throw out_of_range( "MeshHelper::computeNormals: index out of range" );
+		}
+		const Vec3f &a		= positions[ t[ 0 ] ];
+		Vec3f e1			= positions[ t[ 1 ] ] - a;
+		Vec3f e2			= positions[ t[ 2 ] ] - a;
+		Vec3f n				= e1.cross( e2 );
+		if ( !angle ) {
+			normals[ t[ 0 ] ] += n;
+			normals[ t[ 1 ] ] += n;
+			normals[ t[ 2 ] ] += n;
+		} else {
+			float l = n.length();
+			if ( l > 0.0f ) {
+				Vec3f e3 = e2 - e1;
+				n /= l;
+				normals[ t[ 0 ] ] += n * atan2Positive( l, e1.dot( e2 ) );
+				normals[ t[ 1 ] ] += n * atan2Positive( l, -e1.dot( e3 ) );
+				normals[ t[ 2 ] ] += n * atan2Positive( l, e2.dot( e3 ) );
+			}
+		}
+	}
+}
+
+/*! Sums per-vertex values of type T over triangles into \a sums, then calls 
+	\a finish( vertex ) for each vertex. \a accumulate( begin, end, sums, offset, 
+	limit ) adds triangles [begin, end) into \a sums, which holds vertices 
+	[offset, limit), and throws if an index is out of range. Triangle ranges go 
+	to the pool's threads, each summing into its own buffer over the span of 
+	vertices its triangles use, then each vertex adds up the spans covering it 
+	in range order. Ranges have a fixed size rather than one per thread, so the 
+	result doesn't depend on timing or on the thread count. Scattered meshes 
+	would need a near full buffer per range, so they are summed on one thread. */
+template<typename T, typename Accumulate, typename Finish>
+static void sumOverTriangles( WorkerPool &pool, const uint32_t *indices, size_t numTriangles, size_t numVertices, 
+	T *sums, const Accumulate &accumulate, const Finish &finish, const char *error )
+{
+	static const size_t kRangeSize = 16384;
+	size_t numRanges			= math<size_t>::max( ( numTriangles + kRangeSize - 1 ) / kRangeSize, 1 );
+	vector<size_t> ranges( numRanges + 1 );
+	for ( size_t r = 0; r <= numRanges; ++r ) {
+		ranges[ r ] = math<size_t>::min( r * kRangeSize, numTriangles );
+	}
+	vector<size_t> vertexRanges	= pool.split( numVertices, 65536 );
+
+	// Find the vertices each range of triangles uses
+	vector<uint32_t> spanBegin( numRanges, 0 );
+	vector<uint32_t> spanEnd( numRanges, 0 );
+	size_t spanTotal = 0;
+	if ( numRanges > 1 ) {
+		pool.run( numRanges, [ & ]( size_t r )
+		{
+			const uint32_t *begin	= indices + ranges[ r ] * 3;
+			const uint32_t *end		= indices + ranges[ r + 1 ] * 3;
+			uint32_t low			= numeric_limits<uint32_t>::max();
+			uint32_t high			= 0;
+			for ( const uint32_t *iter = begin; iter != end; ++iter ) {
+				uint32_t index	= *iter;
+				low				= index < low ? index : low;
+				high			= index > high ? index : high;
+			}
+			spanBegin[ r ]	= low;
+			spanEnd[ r ]	= high + 1;
+		} );
+		for ( size_t r = 0; r < numRanges; ++r ) {
+			if ( spanEnd[ r ] > numVertices ) {
+				throw out_of_range( error );
+			}
+			spanTotal += spanEnd[ r ] - spanBegin[ r ];
+		}
+	}
+
+	if ( numRanges == 1 || spanTotal > numVertices * 2 ) {
+		fill( sums, sums + numVertices, T() );
+		accumulate( (size_t)0, numTriangles, sums, (uint32_t)0, (uint32_t)numVertices );
+		pool.run( vertexRanges.size() - 1, [ & ]( size_t v )
+		{
+			for ( size_t i = vertexRanges[ v ]; i < vertexRanges[ v + 1 ]; ++i ) {
+				finish( i );
+			}
+		} );
+		return;
+	}
+
+	vector<vector<T> > partials( numRanges );
+	pool.run( numRanges, [ & ]( size_t r )
+	{
+		partials[ r ].assign( spanEnd[ r ] - spanBegin[ r ], T() );
+		accumulate( ranges[ r ], ranges[ r + 1 ], &partials[ r ][ 0 ], spanBegin[ r ], spanEnd[ r ] );
+	} );
+	pool.run( vertexRanges.size() - 1, [ & ]( size_t v )
+	{
+		size_t begin	= vertexRanges[ v ];
+		size_t end		= vertexRanges[ v + 1 ];
+		fill( sums + begin, sums + end, T() );
+		for ( size_t r = 0; r < numRanges; ++r ) {
+			size_t low	= math<size_t>::max( begin, spanBegin[ r ] );
+			size_t high	= math<size_t>::min( end, spanEnd[ r ] );
+			for ( size_t i = low; i < high; ++i ) {
+				sums[ i ] += partials[ r ][ i - spanBegin[ r ] ];
+			}
+		}
+		for ( size_t i = begin; i < end; ++i ) {
+			finish( i );
+		}
+	} );
+}
+
+void MeshHelper::computeNormals( TriMesh &triMesh, NormalWeight weight, uint32_t numThreads )
+{
+	const vector<uint32_t> &indices = triMesh.getIndices();
+	const vector<Vec3f> &positions	= triMesh.getVertices();
+	vector<Vec3f> &normals			= triMesh.getNormals();
+	normals.resize( positions.size() );
+	if ( !positions.empty() ) {
+		computeNormals( indices.empty() ? 0 : &indices[ 0 ], indices.size(), &positions[ 0 ], positions.size(), 
+			&normals[ 0 ], weight, numThreads );
+	}
+}
+
+void MeshHelper::computeNormals( const uint32_t *indices, size_t numIndices, const Vec3f *positions, 
+	size_t numPositions, Vec3f *normals, NormalWeight weight, uint32_t numThreads )
+{
+	size_t numTriangles = numIndices / 3;
+	if ( numThreads == 0 ) {
+		numThreads = math<uint32_t>::max( thread::hardware_concurrency(), 1 );
+	}
+	if ( numTriangles < 65536 ) {
+		numThreads = 1;
+	}
+	WorkerPool pool( numThreads );
+	sumOverTriangles( pool, indices, numTriangles, numPositions, normals, 
+		[ & ]( size_t begin, size_t end, Vec3f *sums, uint32_t offset, uint32_t limit )
+		{
+			accumulateNormals( indices, begin, end, positions, weight, sums, offset, limit );
+		}, 
+		[ & ]( size_t i )
+		{
+			float l = normals[ i ].lengthSquared();
+			if ( l > 0.0f ) {
+				normals[ i ] *= 1.0f / math<float>::sqrt( l );
+			}
+		}, "MeshHelper::computeNormals: index out of range" );
+}
+
+// Sum of the tangent and bitangent directions at a vertex
+struct TangentSum
+{
+	TangentSum& operator+=( const TangentSum &rhs )
+	{
+		mBitangent	+= rhs.mBitangent;
+		mTangent	+= rhs.mTangent;
+		return *this;
+	}
+
+	Vec3f	mBitangent;
+	Vec3f	mTangent;
+};
+
+/*! Returns \a tangent made orthogonal to \a normal, with the sign of \a bitangent 
+	against normal.cross( tangent ) in w. If the tangent is degenerate, any 
+	direction orthogonal to the normal is used. */
+static Vec4f makeTangent( const Vec3f &normal, const Vec3f &tangent, const Vec3f &bitangent )
+{
+	Vec3f t = tangent - normal * normal.dot( tangent );
+	float l = t.lengthSquared();
+	if ( l > 1e-24f ) {
+		t *= 1.0f / math<float>::sqrt( l );
+	} else {
+		t = normal.cross( math<float>::abs( normal.x ) < 0.9f ? Vec3f::xAxis() : Vec3f::yAxis() );
+		l = t.lengthSquared();
+		t = l > 0.0f ? t / math<float>::sqrt( l ) : Vec3f::xAxis();
+	}
+	return Vec4f( t, normal.cross( t ).dot( bitangent ) < 0.0f ? -1.0f : 1.0f );
+}
+
+/*! Adds the texture space directions of triangles [\a begin, \a end) to \a sums, 
+	which holds vertices [\a offset, \a limit). As in MikkTSpace, each corner 
+	adds the directions projected onto its normal's plane, normalized, and 
+	weighted by the corner's angle. */
+static void accumulateTangents( const uint32_t *indices, size_t begin, size_t end, const Vec3f *positions, 
+	const Vec3f *normals, const Vec2f *texCoords, TangentSum *sums, uint32_t offset, uint32_t limit )
+{
+	sums -= offset;
+	for ( size_t i = begin; i < end; ++i ) {
+		const uint32_t *t = indices + i * 3;
+		if ( t[ 0 ] >= limit || t[ 1 ] >= limit || t[ 2 ] >= limit ) {
+			throw out_of_range( "MeshHelper::computeTangents: index out of range" );
+		}
+		Vec3f e1	= positions[ t[ 1 ] ] - positions[ t[ 0 ] ];
+		Vec3f e2	= positions[ t[ 2 ] ] - positions[ t[ 0 ] ];
+		Vec2f d1	= texCoords[ t[ 1 ] ] - texCoords[ t[ 0 ] ];
+		Vec2f d2	= texCoords[ t[ 2 ] ] - texCoords[ t[ 0 ] ];
+		float area	= d1.x * d2.y - d2.x * d1.y;
+		if ( area == 0.0f ) {
+			continue;
+		}
+
+		// Direction of increasing s and t across the triangle. Only their 
+		// directions matter, so the texture area's magnitude is dropped.
+		float sign		= area < 0.0f ? -1.0f : 1.0f;
+		Vec3f sDir		= ( e1 * d2.y - e2 * d1.y ) * sign;
+		Vec3f tDir		= ( e2 * d1.x - e1 * d2.x ) * sign;
+		Vec3f e3		= e2 - e1;
+		float l			= e1.cross( e2 ).length();
+		float angles[]	= { atan2Positive( l, e1.dot( e2 ) ), atan2Positive( l, -e1.dot( e3 ) ), 
+			atan2Positive( l, e2.dot( e3 ) ) };
+		for ( size_t k = 0; k < 3; ++k ) {
+			const Vec3f &n	= normals[ t[ k ] ];
+			Vec3f tangent	= sDir - n * n.dot( sDir );
+			Vec3f bitangent	= tDir - n * n.dot( tDir );
+			float tl		= tangent.lengthSquared();
+			float bl		= bitangent.lengthSquared();
+			if ( tl > 0.0f ) {
+				sums[ t[ k ] ].mTangent += tangent * ( angles[ k ] / math<float>::sqrt( tl ) );
+			}
+			if ( bl > 0.0f ) {
+				sums[ t[ k ] ].mBitangent += bitangent * ( angles[ k ] / math<float>::sqrt( bl ) );
+			}
+		}
+	}
+}
+
+vector<Vec4f> MeshHelper::computeTangents( const TriMesh &triMesh, uint32_t numThreads )
+{
+	const vector<uint32_t> &indices = triMesh.getIndices();
+	const vector<Vec3f> &positions	= triMesh.getVertices();
+	size_t numVertices				= positions.size();
+	vector<Vec4f> tangents( numVertices );
+	if ( numVertices == 0 ) {
+		return tangents;
+	}
+
+	// Fill in whatever attributes are missing
+	vector<Vec3f> normals;
+	vector<Vec2f> texCoords;
+	const Vec3f *n = triMesh.getNormals().size() == numVertices ? &triMesh.getNormals()[ 0 ] : 0;
+	const Vec2f *uv = triMesh.getTexCoords().size() == numVertices ? &triMesh.getTexCoords()[ 0 ] : 0;
+	if ( n == 0 ) {
+		normals.resize( numVertices );
+		computeNormals( indices.empty() ? 0 : &indices[ 0 ], indices.size(), &positions[ 0 ], numVertices, 
+			&normals[ 0 ], NORMAL_WEIGHT_AREA, numThreads );
+		n = &normals[ 0 ];
+	}
+	if ( uv == 0 ) {
+		texCoords.resize( numVertices );
+		uv = &texCoords[ 0 ];
+	}
+	computeTangents( indices.empty() ? 0 : &indices[ 0 ], indices.size(), &positions[ 0 ], n, uv, numVertices, 
+		&tangents[ 0 ], numThreads );
+	return tangents;
+}
+
+void MeshHelper::computeTangents( const uint32_t *indices, size_t numIndices, const Vec3f *positions, 
+	const Vec3f *normals, const Vec2f *texCoords, size_t numVertices, Vec4f *tangents, uint32_t numThreads )
+{
+	size_t numTriangles = numIndices / 3;
+	if ( numThreads == 0 ) {
+		numThreads = math<uint32_t>::max( thread::hardware_concurrency(), 1 );
+	}
+	if ( numTriangles < 65536 ) {
+		numThreads = 1;
+	}
+	WorkerPool pool( numThreads );
+	vector<TangentSum> sums( numVertices );
+	sumOverTriangles( pool, indices, numTriangles, numVertices, sums.empty() ? 0 : &sums[ 0 ], 
+		[ & ]( size_t begin, size_t end, TangentSum *partial, uint32_t offset, uint32_t limit )
+		{
+			accumulateTangents( indices, begin, end, positions, normals, texCoords, partial, offset, limit );
+		}, 
+		[ & ]( size_t i )
+		{
+			tangents[ i ] = makeTangent( normals[ i ], sums[ i ].mTangent, sums[ i ].mBitangent );
+		}, "MeshHelper::computeTangents: index out of range" );
+}
+
+// Closed-form tangents in the order the generators write vertices. Each 
+// follows the texture's s axis, with the sign taken from its t axis.
+
+static void writeCylinderTangents( const Vec2i &resolution, float topRadius, float baseRadius, bool closeTop, 
+	bool closeBase, Vec4f *tangents )
+{
+	SinCosTableRef angles	= SinCosTable::get( (uint32_t)resolution.x );
+	float slope				= topRadius - baseRadius;
+	size_t vertex			= 0;
+	for ( int32_t p = 0; p <= resolution.y; ++p ) {
+		for ( int32_t t = 0; t <= resolution.x; ++t, ++vertex ) {
+			float cosTheta	= angles->getCos( t < resolution.x ? t : 0 );
+			float sinTheta	= angles->getSin( t < resolution.x ? t : 0 );
+			tangents[ vertex ] = makeTangent( Vec3f( cosTheta, 0.0f, sinTheta ), Vec3f( -sinTheta, 0.0f, cosTheta ), 
+				Vec3f( cosTheta * slope, 1.0f, sinTheta * slope ) );
+		}
+	}
+
+	// Caps have a single texture coordinate, so any tangent in their plane will do
+	size_t numCapVertices = ( closeTop ? resolution.x + 1 : 0 ) + ( closeBase ? resolution.x + 1 : 0 );
+	fill( tangents + vertex, tangents + vertex + numCapVertices, Vec4f( 1.0f, 0.0f, 0.0f, 1.0f ) );
+}
+
+static void writeSphereTangents( const Vec2i &resolution, Vec4f *tangents )
+{
+	SinCosTableRef longitude	= SinCosTable::get( (uint32_t)resolution.x );
+	SinCosTableRef latitude		= SinCosTable::get( (uint32_t)resolution.y * 2 );
+	size_t vertex				= 0;
+	for ( int32_t p = 0; p <= resolution.y; ++p ) {
+		float sinPhi	= latitude->getSin( p );
+		float z			= -latitude->getCos( p );
+		for ( int32_t t = 0; t <= resolution.x; ++t, ++vertex ) {
+			int32_t k = t < resolution.x ? t + 1 : 1;
+			Vec3f normal( sinPhi * longitude->getCos( k ), sinPhi * longitude->getSin( k ), z );
+
+			// Texture coordinates are the normal's x and y, so s runs along the 
+			// surface where y is constant and t where x is
+			float sign = normal.z < 0.0f ? -1.0f : 1.0f;
+			tangents[ vertex ] = makeTangent( normal, Vec3f( normal.z, 0.0f, -normal.x ) * sign, 
+				Vec3f( 0.0f, normal.z, -normal.y ) * sign );
+		}
+	}
+}
+
+static void writeTorusTangents( const Vec2i &resolution, Vec4f *tangents )
+{
+	SinCosTableRef tube	= SinCosTable::get( (uint32_t)resolution.y );
+	SinCosTableRef ring	= SinCosTable::get( (uint32_t)resolution.x );
+	size_t vertex		= 0;
+	for ( int32_t p = 0; p <= resolution.x; ++p ) {
+		float cosPhi = -ring->getCos( p < resolution.x ? p : 0 );
+		float sinPhi = -ring->getSin( p < resolution.x ? p : 0 );
+		for ( int32_t t = 0; t <= resolution.y; ++t, ++vertex ) {
+			float cosTheta = tube->getCos( t < resolution.y ? t : 0 );
+			float sinTheta = tube->getSin( t < resolution.y ? t : 0 );
+			Vec3f normal( cosPhi * cosTheta, sinPhi * cosTheta, sinTheta );
+			tangents[ vertex ] = makeTangent( normal, Vec3f( -cosPhi * sinTheta, -sinPhi * sinTheta, cosTheta ), 
+				Vec3f( -sinPhi, cosPhi, 0.0f ) );
+		}
+	}
+}
+
+TriMesh MeshHelper::createCylinder( const Vec2i &resolution, vector<Vec4f> &tangents, float topRadius, 
+	float baseRadius, bool closeTop, bool closeBase, uint32_t flags, MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	createCylinder( builder, resolution, topRadius, baseRadius, closeTop, closeBase, bounds );
+	tangents.resize( mesh.getNumVertices() );
+	if ( !tangents.empty() ) {
+		writeCylinderTangents( resolution, topRadius, baseRadius, closeTop, closeBase, &tangents[ 0 ] );
+	}
+	applyFlags( mesh, flags, tangents );
+	return mesh;
+}
+
+TriMesh MeshHelper::createSphere( const Vec2i &resolution, vector<Vec4f> &tangents, uint32_t flags, 
+	MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	createSphere( builder, resolution, bounds );
+	tangents.resize( mesh.getNumVertices() );
+	if ( !tangents.empty() ) {
+		writeSphereTangents( resolution, &tangents[ 0 ] );
+	}
+	applyFlags( mesh, flags, tangents );
+	return mesh;
+}
+
+TriMesh MeshHelper::createTorus( const Vec2i &resolution, vector<Vec4f> &tangents, float ratio, uint32_t flags, 
+	MeshBounds *bounds )
+{
+	TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	createTorus( builder, resolution, ratio, bounds );
+	tangents.resize( mesh.getNumVertices() );
+	if ( !tangents.empty() ) {
+		writeTorusTangents( resolution, &tangents[ 0 ] );
+	}
+	applyFlags( mesh, flags, tangents );
+	return mesh;
 }
@@ -35,45 +35,978 @@
 
 #pragma once
 
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Matrix.h"
+#include "cinder/Sphere.h"
 #include "cinder/TriMesh.h"
 
+#include <functional>
+#include <memory>
+#include <vector>
+
+/*! Layout of an interleaved vertex: byte offsets of each attribute within 
+	one vertex and the stride between vertices. Attributes are packed in the 
+	order position, normal, texture coordinate, each starting on a 4-byte 
+	boundary. */
+class VertexFormat
+{
+public:
+	enum PositionType
+	{
+		POSITION_FLOAT,		//!< Three floats, 12 bytes
+		POSITION_HALF,		//!< Three half floats plus padding, 8 bytes
+		POSITION_SNORM16	//!< Three signed 16-bit integers mapping [-1, 1] plus padding, 8 bytes
+	};
+
+	enum NormalType
+	{
+		NORMAL_NONE,
+		NORMAL_FLOAT,		//!< Three floats, 12 bytes
+		NORMAL_OCT16		//!< Octahedral encoding in two signed 16-bit integers, 4 bytes
+	};
+
+	enum TexCoordType
+	{
+		TEX_COORD_NONE,
+		TEX_COORD_FLOAT,	//!< Two floats, 8 bytes
+		TEX_COORD_UNORM16	//!< Two unsigned 16-bit integers mapping [0, 1], 4 bytes
+	};
+
+	/*! Packs a float position plus optional normal and texture coordinate, then 
+		pads the stride up to a multiple of \a alignment bytes (eg, 16 or 32). */
+	explicit VertexFormat( bool normals = true, bool texCoords = true, size_t alignment = 0 );
+	/*! Packs attributes in the given encodings, then pads the stride up to a 
+		multiple of \a alignment bytes. Quantized positions are meant for the 
+		primitives' own unit bounds; snorm16 positions outside [-1, 1] are clamped. */
+	VertexFormat( PositionType position, NormalType normal, TexCoordType texCoord, size_t alignment = 0 );
+
+	size_t			getNormalOffset() const { return mNormalOffset; }
+	NormalType		getNormalType() const { return mNormalType; }
+	size_t			getPositionOffset() const { return mPositionOffset; }
+	PositionType	getPositionType() const { return mPositionType; }
+	size_t			getStride() const { return mStride; }
+	size_t			getTexCoordOffset() const { return mTexCoordOffset; }
+	TexCoordType	getTexCoordType() const { return mTexCoordType; }
+	bool			hasNormals() const { return mNormalType != NORMAL_NONE; }
+	bool			hasTexCoords() const { return mTexCoordType != TEX_COORD_NONE; }
+	//! Returns true if any attribute is stored in a reduced precision encoding.
+	bool			isQuantized() const;
+
+	ci::Vec3f		decodeNormal( const void *data ) const;
+	ci::Vec3f		decodePosition( const void *data ) const;
+	ci::Vec2f		decodeTexCoord( const void *data ) const;
+	void			encodeNormal( void *data, const ci::Vec3f &normal ) const;
+	void			encodePosition( void *data, const ci::Vec3f &position ) const;
+	void			encodeTexCoord( void *data, const ci::Vec2f &texCoord ) const;
+private:
+	void			layout( size_t alignment );
+
+	size_t			mNormalOffset;
+	NormalType		mNormalType;
+	size_t			mPositionOffset;
+	PositionType	mPositionType;
+	size_t			mStride;
+	size_t			mTexCoordOffset;
+	TexCoordType	mTexCoordType;
+};
+
+//! Precision lost by quantizing a mesh, as returned by MeshHelper::measureQuantizationError.
+struct QuantizationError
+{
+	//! Largest and mean distance between quantized and reference positions.
+	float	mMaxPosition;
+	float	mMeanPosition;
+	//! Largest and mean angle between quantized and reference normals, in degrees.
+	float	mMaxNormalAngle;
+	float	mMeanNormalAngle;
+	//! Largest distance between quantized and reference texture coordinates.
+	float	mMaxTexCoord;
+	//! Vertex data size in bytes of the quantized mesh and of the float reference.
+	size_t	mNumBytes;
+	size_t	mNumReferenceBytes;
+};
+
+/*! Axis-aligned box and bounding sphere of a mesh, as returned by the MeshHelper 
+	generators and MeshHelper::computeBounds. Empty meshes have zero bounds. */
+struct MeshBounds
+{
+	MeshBounds()
+		: mCenter( ci::Vec3f::zero() ), mMax( ci::Vec3f::zero() ), mMin( ci::Vec3f::zero() ), mRadius( 0.0f )
+	{
+	}
+	MeshBounds( const ci::Vec3f &min, const ci::Vec3f &max, const ci::Vec3f &center, float radius )
+		: mCenter( center ), mMax( max ), mMin( min ), mRadius( radius )
+	{
+	}
+
+	ci::AxisAlignedBox3f	getBox() const { return ci::AxisAlignedBox3f( mMin, mMax ); }
+	ci::Sphere				getSphere() const { return ci::Sphere( mCenter, mRadius ); }
+
+	ci::Vec3f				mCenter;
+	ci::Vec3f				mMax;
+	ci::Vec3f				mMin;
+	float					mRadius;
+};
+
+//! A point on a parametric surface, as returned by the callable passed to MeshHelper::createParametric.
+struct SurfacePoint
+{
+	SurfacePoint()
+		: mNormal( ci::Vec3f::zero() ), mPosition( ci::Vec3f::zero() )
+	{
+	}
+	SurfacePoint( const ci::Vec3f &position, const ci::Vec3f &normal )
+		: mNormal( normal ), mPosition( position )
+	{
+	}
+
+	ci::Vec3f	mNormal;
+	ci::Vec3f	mPosition;
+};
+
+//! Vertex and index counts of a mesh, as returned by the MeshHelper::query* functions.
+class MeshSize
+{
+public:
+	MeshSize( size_t numVertices = 0, size_t numIndices = 0 )
+		: mNumIndices( numIndices ), mNumVertices( numVertices )
+	{
+	}
+
+	//! Returns size in bytes of the indices, positions, normals and texture coordinates.
+	size_t	getNumBytes() const 
+	{
+		return mNumIndices * sizeof( uint32_t ) + 
+			mNumVertices * ( sizeof( ci::Vec3f ) * 2 + sizeof( ci::Vec2f ) );
+	}
+	//! Returns size in bytes of the indices and vertices interleaved as \a format.
+	size_t	getNumBytes( const VertexFormat &format ) const 
+	{
+		return mNumIndices * sizeof( uint32_t ) + mNumVertices * format.getStride();
+	}
+	size_t	getNumIndices() const { return mNumIndices; }
+	size_t	getNumTriangles() const { return mNumIndices / 3; }
+	size_t	getNumVertices() const { return mNumVertices; }
+private:
+	size_t	mNumIndices;
+	size_t	mNumVertices;
+};
+
+class SinCosTable;
+typedef std::shared_ptr<const SinCosTable> SinCosTableRef;
+
+/*! Cosines and sines of 2 * pi * i / n for i in [0, n], where n is the 
+	segment count, so a full turn's last angle closes the loop exactly. 
+	Tables are computed in double precision, from the index rather than 
+	by stepping, and cached for reuse by every generator and call. */
+class SinCosTable
+{
+public:
+	/*! Returns the table for \a numSegments segments, computing it on first 
+		use. The cache is thread-safe. Returned tables stay valid after the 
+		cache drops them. */
+	static SinCosTableRef	get( uint32_t numSegments );
+
+	const float*	getCos() const { return &mCos[ 0 ]; }
+	float			getCos( size_t i ) const { return mCos[ i ]; }
+	uint32_t		getNumSegments() const { return mNumSegments; }
+	const float*	getSin() const { return &mSin[ 0 ]; }
+	float			getSin( size_t i ) const { return mSin[ i ]; }
+private:
+	explicit SinCosTable( uint32_t numSegments );
+
+	std::vector<float>	mCos;
+	uint32_t			mNumSegments;
+	std::vector<float>	mSin;
+};
+
+/*! Interleaved vertex stream and index stream, ready to be copied into 
+	GPU buffers as they are. */
+class InterleavedMesh
+{
+public:
+	explicit InterleavedMesh( const VertexFormat &format = VertexFormat() );
+
+	void							clear();
+
+	const VertexFormat&				getFormat() const { return mFormat; }
+	std::vector<uint32_t>&			getIndices() { return mIndices; }
+	const std::vector<uint32_t>&	getIndices() const { return mIndices; }
+	size_t							getNumIndices() const { return mIndices.size(); }
+	size_t							getNumVertices() const { return mVertices.size() / mFormat.getStride(); }
+	//! Returns raw vertex data, getFormat().getStride() bytes per vertex.
+	std::vector<uint8_t>&			getVertices() { return mVertices; }
+	const std::vector<uint8_t>&		getVertices() const { return mVertices; }
+private:
+	VertexFormat					mFormat;
+	std::vector<uint32_t>			mIndices;
+	std::vector<uint8_t>			mVertices;
+};
+
+/*! Contiguous run of triangles in a TriMesh16. Its indices are relative 
+	to \a mBaseVertex, and it uses \a mNumVertices vertices from there on. */
+struct DrawRange
+{
+	uint32_t	mBaseVertex;
+	uint32_t	mFirstIndex;
+	uint32_t	mNumIndices;
+	uint32_t	mNumVertices;
+};
+
+/*! Mesh with 16-bit indices. Meshes with more than 65535 vertices are 
+	split into draw ranges which each fit. */
+class TriMesh16
+{
+public:
+	void								clear();
+
+	std::vector<DrawRange>&				getDrawRanges() { return mDrawRanges; }
+	const std::vector<DrawRange>&		getDrawRanges() const { return mDrawRanges; }
+	std::vector<uint16_t>&				getIndices() { return mIndices; }
+	const std::vector<uint16_t>&		getIndices() const { return mIndices; }
+	std::vector<ci::Vec3f>&				getNormals() { return mNormals; }
+	const std::vector<ci::Vec3f>&		getNormals() const { return mNormals; }
+	size_t								getNumIndices() const { return mIndices.size(); }
+	size_t								getNumVertices() const { return mVertices.size(); }
+	std::vector<ci::Vec2f>&				getTexCoords() { return mTexCoords; }
+	const std::vector<ci::Vec2f>&		getTexCoords() const { return mTexCoords; }
+	std::vector<ci::Vec3f>&				getVertices() { return mVertices; }
+	const std::vector<ci::Vec3f>&		getVertices() const { return mVertices; }
+private:
+	std::vector<DrawRange>				mDrawRanges;
+	std::vector<uint16_t>				mIndices;
+	std::vector<ci::Vec3f>				mNormals;
+	std::vector<ci::Vec2f>				mTexCoords;
+	std::vector<ci::Vec3f>				mVertices;
+};
+
+//! One level of detail in a LodChain.
+struct LodLevel
+{
+	//! Indices of this level in the chain's shared mesh.
+	DrawRange	mRange;
+	//! Largest distance from this level to the exact surface, in object units.
+	float		mError;
+};
+
+/*! Levels of detail of one primitive, finest first. All levels share the 
+	vertices of the finest one, so they live in a single TriMesh and only 
+	differ by which indices are drawn. 
+
+	Chains built with MeshHelper::ATTRIB_PARENT_POSITION also carry geomorph 
+	data. Each vertex has a level, the coarsest one that draws it, and a parent 
+	position, where it lies on the next coarser level's surface. Drawing level 
+	L, a vertex shader moves vertices whose level is L toward their parent by 
+	getMorphFactor(), so the mesh turns into level L + 1 before it is swapped in. */
+class LodChain
+{
+public:
+	void							clear();
+
+	std::vector<LodLevel>&			getLevels() { return mLevels; }
+	const std::vector<LodLevel>&	getLevels() const { return mLevels; }
+	ci::TriMesh&					getMesh() { return mMesh; }
+	const ci::TriMesh&				getMesh() const { return mMesh; }
+	//! Returns each vertex's position on the next coarser level, or its own on the coarsest.
+	std::vector<ci::Vec3f>&			getParentPositions() { return mParentPositions; }
+	const std::vector<ci::Vec3f>&	getParentPositions() const { return mParentPositions; }
+	//! Returns the coarsest level drawing each vertex.
+	std::vector<uint8_t>&			getVertexLevels() { return mVertexLevels; }
+	const std::vector<uint8_t>&		getVertexLevels() const { return mVertexLevels; }
+	bool							hasParentPositions() const { return !mParentPositions.empty(); }
+
+	/*! Returns the coarsest level whose error, seen from \a distance, is at most 
+		\a maxPixelError pixels. \a projectionScale is the viewport height in pixels 
+		over 2 * tan( fovy / 2 ). */
+	size_t							selectLevel( float distance, float projectionScale, 
+		float maxPixelError = 1.0f ) const;
+	/*! Returns how far \a level, seen from \a distance, has morphed toward the next 
+		coarser level, from 0 while that level's error is above twice \a maxPixelError 
+		to 1 where selectLevel() switches to it. */
+	float							getMorphFactor( size_t level, float distance, float projectionScale, 
+		float maxPixelError = 1.0f ) const;
+private:
+	std::vector<LodLevel>			mLevels;
+	ci::TriMesh						mMesh;
+	std::vector<ci::Vec3f>			mParentPositions;
+	std::vector<uint8_t>			mVertexLevels;
+};
+
+/*! Cluster of up to MeshletMesh::getMaxTriangles() triangles using up to 
+	MeshletMesh::getMaxVertices() vertices, with bounds for culling it whole. */
+struct Meshlet
+{
+	//! Returns true if every triangle faces away from \a eye, so the meshlet can be skipped.
+	bool		isBackFacing( const ci::Vec3f &eye ) const
+	{
+		ci::Vec3f direction = mCenter - eye;
+		return direction.dot( mConeAxis ) >= mConeCutoff * direction.length() + mRadius;
+	}
+
+	//! First entry and count in MeshletMesh::getVertices().
+	uint32_t	mVertexOffset;
+	uint32_t	mNumVertices;
+	//! First triangle and count in MeshletMesh::getTriangles(), at three bytes each.
+	uint32_t	mTriangleOffset;
+	uint32_t	mNumTriangles;
+
+	//! Bounding sphere.
+	ci::Vec3f	mCenter;
+	float		mRadius;
+	/*! Normal cone. \a mConeCutoff is the sine of the widest angle between a 
+		triangle normal and \a mConeAxis, or 1 if the cone is too wide to cull. */
+	ci::Vec3f	mConeAxis;
+	float		mConeCutoff;
+};
+
+/*! Mesh split into meshlets. Each meshlet lists the source vertices it uses, 
+	and its triangles index that list with one byte per corner. */
+class MeshletMesh
+{
+public:
+	explicit MeshletMesh( uint32_t maxVertices = 64, uint32_t maxTriangles = 126 );
+
+	void								clear();
+
+	uint32_t							getMaxTriangles() const { return mMaxTriangles; }
+	uint32_t							getMaxVertices() const { return mMaxVertices; }
+	std::vector<Meshlet>&				getMeshlets() { return mMeshlets; }
+	const std::vector<Meshlet>&			getMeshlets() const { return mMeshlets; }
+	std::vector<uint8_t>&				getTriangles() { return mTriangles; }
+	const std::vector<uint8_t>&			getTriangles() const { return mTriangles; }
+	std::vector<uint32_t>&				getVertices() { return mVertices; }
+	const std::vector<uint32_t>&		getVertices() const { return mVertices; }
+
+	//! Returns the mean number of triangles per meshlet over the maximum.
+	float								getTriangleFill() const;
+	//! Returns the mean number of vertices per meshlet over the maximum.
+	float								getVertexFill() const;
+private:
+	uint32_t							mMaxTriangles;
+	uint32_t							mMaxVertices;
+	std::vector<Meshlet>				mMeshlets;
+	std::vector<uint8_t>				mTriangles;
+	std::vector<uint32_t>				mVertices;
+};
+
+/*! Destination for MeshHelper generators. Writes into a TriMesh, an 
+	InterleavedMesh or a TriMesh16, sizing their arrays to fit, or straight 
+	into caller-owned arrays. Destinations with 16-bit indices only accept 
+	meshes of up to 65535 vertices; use MeshHelper::split for larger ones. */
+class MeshBuilder
+{
+public:
+	//! Builds into \a mesh, replacing its contents.
+	explicit MeshBuilder( ci::TriMesh &mesh );
+	/*! Builds into \a mesh, replacing its contents. Only the attributes in 
+		\a attribs (see MeshHelper::ATTRIB_NORMAL) are allocated and written. */
+	MeshBuilder( ci::TriMesh &mesh, uint32_t attribs );
+	//! Builds into \a mesh, replacing its contents.
+	explicit MeshBuilder( InterleavedMesh &mesh );
+	//! Builds into \a mesh as a single draw range, replacing its contents.
+	explicit MeshBuilder( TriMesh16 &mesh );
+	/*! Builds into \a mesh as a single draw range, replacing its contents. Only 
+		the attributes in \a attribs are allocated and written. */
+	MeshBuilder( TriMesh16 &mesh, uint32_t attribs );
+	/*! Builds into caller-owned arrays with room for \a numIndices indices and 
+		\a numVertices vertices. \a normals and \a texCoords may be null. */
+	MeshBuilder( uint32_t *indices, size_t numIndices, ci::Vec3f *positions, ci::Vec3f *normals, 
+		ci::Vec2f *texCoords, size_t numVertices );
+	MeshBuilder( uint16_t *indices, size_t numIndices, ci::Vec3f *positions, ci::Vec3f *normals, 
+		ci::Vec2f *texCoords, size_t numVertices );
+	/*! Builds into caller-owned memory with room for \a numIndices indices and 
+		\a numVertices vertices interleaved as \a format, eg, a mapped buffer. */
+	MeshBuilder( uint32_t *indices, size_t numIndices, void *vertices, const VertexFormat &format, 
+		size_t numVertices );
+	MeshBuilder( uint16_t *indices, size_t numIndices, void *vertices, const VertexFormat &format, 
+		size_t numVertices );
+
+	/*! Makes room for \a numVertices vertices and \a numIndices indices. Returns 
+		false if caller-owned arrays are too small. */
+	bool				allocate( size_t numVertices, size_t numIndices );
+	//! Makes room for a mesh of \a size.
+	bool				allocate( const MeshSize &size ) { return allocate( size.getNumVertices(), size.getNumIndices() ); }
+
+	size_t				getNumIndices() const { return mNumIndices; }
+	size_t				getNumVertices() const { return mNumVertices; }
+	bool				hasNormals() const { return mNormals != 0; }
+	bool				hasTexCoords() const { return mTexCoords != 0; }
+
+	ci::Vec3f			getPosition( size_t i ) const 
+	{ 
+		const uint8_t *data = mPositions + i * mPositionStride;
+		return !mQuantized ? *reinterpret_cast<const ci::Vec3f*>( data ) : mFormat.decodePosition( data ); 
+	}
+	void				setPosition( size_t i, const ci::Vec3f &position ) 
+	{ 
+		uint8_t *data = mPositions + i * mPositionStride;
+		if ( !mQuantized ) {
+			*reinterpret_cast<ci::Vec3f*>( data ) = position; 
+		} else {
+			mFormat.encodePosition( data, position );
+		}
+	}
+	void				setNormal( size_t i, const ci::Vec3f &normal ) 
+	{ 
+		if ( mNormals != 0 ) {
+			uint8_t *data = mNormals + i * mNormalStride;
+			if ( !mQuantized ) {
+				*reinterpret_cast<ci::Vec3f*>( data ) = normal; 
+			} else {
+				mFormat.encodeNormal( data, normal );
+			}
+		}
+	}
+	void				setTexCoord( size_t i, const ci::Vec2f &texCoord ) 
+	{ 
+		if ( mTexCoords != 0 ) {
+			uint8_t *data = mTexCoords + i * mTexCoordStride;
+			if ( !mQuantized ) {
+				*reinterpret_cast<ci::Vec2f*>( data ) = texCoord; 
+			} else {
+				mFormat.encodeTexCoord( data, texCoord );
+			}
+		}
+	}
+	//! Writes triangle \a a, \a b, \a c starting at index \a i.
+	void				setTriangle( size_t i, uint32_t a, uint32_t b, uint32_t c )
+	{
+		if ( mIndices16 != 0 ) {
+			mIndices16[ i + 0 ] = (uint16_t)a;
+			mIndices16[ i + 1 ] = (uint16_t)b;
+			mIndices16[ i + 2 ] = (uint16_t)c;
+		} else {
+			mIndices[ i + 0 ] = a;
+			mIndices[ i + 1 ] = b;
+			mIndices[ i + 2 ] = c;
+		}
+	}
+private:
+	void				setVertices( uint8_t *vertices, const VertexFormat &format );
+
+	uint32_t			mAttribs;
+	VertexFormat		mFormat;
+	size_t				mIndexCapacity;
+	uint32_t			*mIndices;
+	uint16_t			*mIndices16;
+	InterleavedMesh		*mInterleavedMesh;
+	ci::TriMesh			*mMesh;
+	TriMesh16			*mMesh16;
+	uint8_t				*mNormals;
+	size_t				mNormalStride;
+	size_t				mNumIndices;
+	size_t				mNumVertices;
+	uint8_t				*mPositions;
+	size_t				mPositionStride;
+	//! True when mFormat stores any attribute in a reduced precision encoding.
+	bool				mQuantized;
+	uint8_t				*mTexCoords;
+	size_t				mTexCoordStride;
+	size_t				mVertexCapacity;
+};
+
+/*! Describes how MeshHelper writes into vertex type \a V. The default 
+	expects \a V to have \a mPosition, \a mNormal and \a mTexCoord members. 
+	Specialize it for other vertex types, setting \a kHasNormal or 
+	\a kHasTexCoord to false for attributes \a V doesn't store. Those 
+	attributes are then compiled out of the generators, and their setters 
+	can be left out of the specialization. */
+template<typename V>
+struct VertexTraits
+{
+	static const bool			kHasNormal		= true;
+	static const bool			kHasTexCoord	= true;
+
+	static const ci::Vec3f&		getPosition( const V &vertex ) { return vertex.mPosition; }
+	static void					setNormal( V &vertex, const ci::Vec3f &normal ) { vertex.mNormal = normal; }
+	static void					setPosition( V &vertex, const ci::Vec3f &position ) { vertex.mPosition = position; }
+	static void					setTexCoord( V &vertex, const ci::Vec2f &texCoord ) { vertex.mTexCoord = texCoord; }
+};
+
+//! Vertices of a user-defined type \a V plus an index stream.
+template<typename V>
+class VertexMesh
+{
+public:
+	void							clear() { mIndices.clear(); mVertices.clear(); }
+
+	std::vector<uint32_t>&			getIndices() { return mIndices; }
+	const std::vector<uint32_t>&	getIndices() const { return mIndices; }
+	size_t							getNumIndices() const { return mIndices.size(); }
+	size_t							getNumVertices() const { return mVertices.size(); }
+	std::vector<V>&					getVertices() { return mVertices; }
+	const std::vector<V>&			getVertices() const { return mVertices; }
+private:
+	std::vector<uint32_t>			mIndices;
+	std::vector<V>					mVertices;
+};
+
+/*! Generator destination that writes into a VertexMesh of \a V through 
+	\a Traits. Unlike MeshBuilder, which attributes are written is decided 
+	at compile time. */
+template<typename V, typename Traits = VertexTraits<V> >
+class VertexBuilder
+{
+	template<bool value> struct Enabled {};
+public:
+	explicit VertexBuilder( VertexMesh<V> &mesh )
+		: mMesh( mesh )
+	{
+	}
+
+	bool				allocate( size_t numVertices, size_t numIndices )
+	{
+		mMesh.getIndices().resize( numIndices );
+		mMesh.getVertices().resize( numVertices );
+		return true;
+	}
+	bool				allocate( const MeshSize &size ) { return allocate( size.getNumVertices(), size.getNumIndices() ); }
+
+	size_t				getNumIndices() const { return mMesh.getNumIndices(); }
+	size_t				getNumVertices() const { return mMesh.getNumVertices(); }
+	bool				hasNormals() const { return Traits::kHasNormal; }
+	bool				hasTexCoords() const { return Traits::kHasTexCoord; }
+
+	ci::Vec3f			getPosition( size_t i ) const { return Traits::getPosition( mMesh.getVertices()[ i ] ); }
+	void				setPosition( size_t i, const ci::Vec3f &position ) { Traits::setPosition( mMesh.getVertices()[ i ], position ); }
+	void				setNormal( size_t i, const ci::Vec3f &normal ) { setNormal( i, normal, Enabled<Traits::kHasNormal>() ); }
+	void				setTexCoord( size_t i, const ci::Vec2f &texCoord ) { setTexCoord( i, texCoord, Enabled<Traits::kHasTexCoord>() ); }
+	void				setTriangle( size_t i, uint32_t a, uint32_t b, uint32_t c )
+	{
+		uint32_t *indices = &mMesh.getIndices()[ i ];
+		indices[ 0 ] = a;
+		indices[ 1 ] = b;
+		indices[ 2 ] = c;
+	}
+private:
+	void				setNormal( size_t i, const ci::Vec3f &normal, Enabled<true> ) { Traits::setNormal( mMesh.getVertices()[ i ], normal ); }
+	void				setNormal( size_t, const ci::Vec3f &, Enabled<false> ) {}
+	void				setTexCoord( size_t i, const ci::Vec2f &texCoord, Enabled<true> ) { Traits::setTexCoord( mMesh.getVertices()[ i ], texCoord ); }
+	void				setTexCoord( size_t, const ci::Vec2f &, Enabled<false> ) {}
+
+	VertexMesh<V>		&mMesh;
+};
+
 class MeshHelper 
 {
 public:
+	/*! Generator flags, combined into a mask. ATTRIB_ flags select optional vertex 
+		attributes (positions are always generated). OPTIMIZE_ flags run a pass on 
+		the result before it is returned. */
+	enum
+	{
+		ATTRIB_NORMAL			= 1 << 0, 
+		ATTRIB_TEX_COORD		= 1 << 1, 
+		ATTRIB_ALL				= ATTRIB_NORMAL | ATTRIB_TEX_COORD, 
+		//! Geomorph data, for LOD chains only. See LodChain.
+		ATTRIB_PARENT_POSITION	= 1 << 2, 
+
+		OPTIMIZE_VERTEX_CACHE	= 1 << 8, 
+		OPTIMIZE_VERTEX_FETCH	= 1 << 9, 
+		OPTIMIZE_OVERDRAW		= 1 << 10
+	};
+
+	//! How computeNormals() weights each triangle's share of a vertex normal.
+	enum NormalWeight
+	{
+		NORMAL_WEIGHT_AREA, 
+		NORMAL_WEIGHT_ANGLE
+	};
+
+	/*! Directions in which a createParametric() surface closes on itself, combined 
+		into a mask. PARAMETRIC_SHARE_SEAMS makes wrapped directions reuse their 
+		first lattice line as their last. */
+	enum
+	{
+		PARAMETRIC_WRAP_U		= 1 << 0, 
+		PARAMETRIC_WRAP_V		= 1 << 1, 
+		PARAMETRIC_SHARE_SEAMS	= 1 << 2
+	};
+
 	//! Create TriMesh from vectors of vertex data.
 	static ci::TriMesh		create( std::vector<uint32_t> &indices, const std::vector<ci::Vec3f> &positions,
 									const std::vector<ci::Vec3f> &normals, const std::vector<ci::Vec2f> &texCoords );
+	//! Create TriMesh from vectors of vertex data, taking over their storage without copying.
+	static ci::TriMesh		create( std::vector<uint32_t> &&indices, std::vector<ci::Vec3f> &&positions,
+									std::vector<ci::Vec3f> &&normals, std::vector<ci::Vec2f> &&texCoords );
+	/*! Convert \a triMesh to 16-bit indices. If it has more than \a maxVertices 
+		vertices, its triangles are split, in order, into draw ranges which each 
+		use at most \a maxVertices vertices. Vertices shared across ranges are 
+		duplicated. \a maxVertices is clamped to [3, 65535]. */
+	static TriMesh16		split( const ci::TriMesh &triMesh, uint32_t maxVertices = 65535 );
+	/*! Compare \a mesh to \a reference, a float mesh with the same vertices, eg, 
+		the same primitive generated as a TriMesh. */
+	static QuantizationError	measureQuantizationError( const InterleavedMesh &mesh, const ci::TriMesh &reference );
+	/*! Interleave \a triMesh as \a format. Attributes missing from \a triMesh 
+		are zeroed. */
+	static InterleavedMesh	interleave( const ci::TriMesh &triMesh, const VertexFormat &format = VertexFormat() );
 	/*! Subdivide vectors of vertex data into a TriMesh \a division times. Division less 
-		than 2 returns the original mesh. */
+		than 2 returns the original mesh. Each edge is split once, so neighboring 
+		triangles share their midpoints. Large meshes are split across \a numThreads 
+		threads, or one per core if zero. The subdivide functions write the result's 
+		bounds to \a bounds if it isn't null. Unless \a normalize is set, these come 
+		from the smaller source mesh, as midpoints never leave its hull. */
 	static ci::TriMesh		subdivide( std::vector<uint32_t> &indices, const std::vector<ci::Vec3f> &positions,
 								const std::vector<ci::Vec3f> &normals, const std::vector<ci::Vec2f> &texCoords, 
-								uint32_t division = 2, bool normalize = false );
-	//! Subdivide a TriMesh \a division times. Division less than 2 returns the original mesh. 
-	static ci::TriMesh		subdivide( const ci::TriMesh &triMesh, uint32_t division = 2, bool normalize = false );
+								uint32_t division = 2, bool normalize = false, uint32_t numThreads = 0, 
+								uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	/*! Subdivide vectors of vertex data into a TriMesh \a division times, taking over 
+		their storage. New vertices are appended in place, so nothing is copied. */
+	static ci::TriMesh		subdivide( std::vector<uint32_t> &&indices, std::vector<ci::Vec3f> &&positions,
+								std::vector<ci::Vec3f> &&normals, std::vector<ci::Vec2f> &&texCoords, 
+								uint32_t division = 2, bool normalize = false, uint32_t numThreads = 0, 
+								uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	/*! Subdivide a TriMesh \a division times. Division less than 2 returns the original mesh. 
+		Each edge is split once, so neighboring triangles share their midpoints. Large 
+		meshes are split across \a numThreads threads, or one per core if zero. The 
+		result is the same for any thread count. Attributes left out of \a flags 
+		are dropped rather than subdivided. */
+	static ci::TriMesh		subdivide( const ci::TriMesh &triMesh, uint32_t division = 2, bool normalize = false, 
+		uint32_t numThreads = 0, uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	/*! Subdivide a TriMesh as above, also writing each vertex's position on the 
+		previous division into \a parentPositions. Original vertices keep their own 
+		position and each midpoint gets the middle of its edge before normalizing, 
+		so a vertex shader can blend between the two levels. */
+	static ci::TriMesh		subdivide( const ci::TriMesh &triMesh, std::vector<ci::Vec3f> &parentPositions, 
+		uint32_t division = 2, bool normalize = false, uint32_t numThreads = 0, uint32_t flags = ATTRIB_ALL, 
+		MeshBounds *bounds = 0 );
+
+	/*! Reorder the triangles of \a triMesh so vertices are reused while they are 
+		still in the GPU's post-transform cache, using Forsyth's linear-speed 
+		algorithm. Vertices and winding are left as they are. */
+	static void				optimizeVertexCache( ci::TriMesh &triMesh );
+	//! Reorder \a numIndices triangle list \a indices in place. See above.
+	static void				optimizeVertexCache( uint32_t *indices, size_t numIndices, size_t numVertices );
+	/*! Returns the average cache miss ratio (ACMR) of \a triMesh, ie, vertices 
+		transformed per triangle through a FIFO cache of \a cacheSize entries. 
+		This is 3 with no reuse and approaches 0.5 on large regular grids. */
+	static float			calcAcmr( const ci::TriMesh &triMesh, uint32_t cacheSize = 16 );
+	static float			calcAcmr( const uint32_t *indices, size_t numIndices, size_t numVertices, 
+		uint32_t cacheSize = 16 );
+	/*! Renumber the vertices of \a triMesh in the order its indices first use them, 
+		so vertex fetches stream through memory. Positions, normals and texture 
+		coordinates are moved with one shared remap. Vertices no triangle uses are 
+		kept, after the rest. Run this after optimizeVertexCache(), which it does 
+		not undo. */
+	static void				optimizeVertexFetch( ci::TriMesh &triMesh );
+	/*! Reorder the triangles of \a triMesh, already ordered by optimizeVertexCache(), 
+		to cut overdraw from any direction. Triangles are split into clusters whose 
+		ACMR stays within \a threshold times the original's, eg, 1.05 for 5% slack, 
+		then clusters facing away from the mesh's center are drawn first. This suits 
+		closed shapes. OPTIMIZE_OVERDRAW runs both passes. */
+	static void				optimizeOverdraw( ci::TriMesh &triMesh, float threshold = 1.05f, uint32_t cacheSize = 16 );
+	/*! Returns the average overdraw of \a triMesh, ie, fragments shaded per pixel 
+		covered, rendered with back face culling and a depth test from six axis 
+		views at \a resolution pixels square. 1 is ideal. */
+	static float			calcOverdraw( const ci::TriMesh &triMesh, uint32_t resolution = 256 );
+	/*! Convert triangle list \a indices to triangle strips for drawing with 
+		primitive restart. Strips are separated by the restart index for the index 
+		width, ie, 0xFFFFFFFF, which must not be used as a vertex. Winding is kept. 
+		The lattices from the generators become one strip per row or ring, about a 
+		third of the list's size. */
+	static std::vector<uint32_t>	stripify( const std::vector<uint32_t> &indices );
+	/*! Convert 16-bit triangle list \a indices to strips separated by 0xFFFF. For 
+		a TriMesh16 with several draw ranges, convert each range separately. */
+	static std::vector<uint16_t>	stripify( const std::vector<uint16_t> &indices );
+	/*! Split \a triMesh into meshlets of at most \a maxVertices vertices (up to 255) 
+		and \a maxTriangles triangles. Each meshlet grows from its first triangle 
+		across neighbors which add the fewest new vertices, so meshlets stay compact. 
+		Normal cones follow the index winding. */
+	static MeshletMesh		buildMeshlets( const ci::TriMesh &triMesh, uint32_t maxVertices = 64, 
+		uint32_t maxTriangles = 126 );
+	/*! Reduce \a triMesh to about \a targetTriangles triangles by collapsing edges in 
+		order of quadric error, stopping early rather than exceed \a maxError. Errors 
+		are relative to the mesh's largest extent, eg, 0.01 for 1%, and include 
+		deviation in normals and texture coordinates scaled by \a normalWeight and 
+		\a texCoordWeight. Vertices on open edges or attribute seams stay in place. 
+		The largest error reached is written to \a resultError. */
+	static ci::TriMesh		simplify( const ci::TriMesh &triMesh, size_t targetTriangles, float maxError = 0.01f, 
+		float normalWeight = 0.5f, float texCoordWeight = 1.0f, float *resultError = 0 );
+	/*! Returns the bounds of \a triMesh's positions, scanned four at a time with 
+		SSE where available. The sphere is grown from the box's center with 
+		Ritter's method, or centered on the box if that is smaller. */
+	static MeshBounds		computeBounds( const ci::TriMesh &triMesh );
+	static MeshBounds		computeBounds( const ci::Vec3f *positions, size_t numPositions );
+	/*! Replace the normals of \a triMesh with smooth vertex normals, summing the 
+		normals of the triangles around each vertex weighted by \a weight, ie, 
+		triangle area or the angle at the vertex. Face normals are computed four at 
+		a time with SSE where available. Large meshes are split across \a numThreads 
+		threads, or one per core if zero, each summing into its own buffer over the 
+		vertices its triangles use, so meshes whose triangles and vertices are in 
+		similar order, like the generators' or optimizeVertexFetch()'s output, scale 
+		best. The result is the same for any thread count. Normals face the side 
+		from which triangles wind counterclockwise. Vertices no triangle uses get a 
+		zero normal. */
+	static void				computeNormals( ci::TriMesh &triMesh, NormalWeight weight = NORMAL_WEIGHT_AREA, 
+		uint32_t numThreads = 0 );
+	//! Write a normal for each of \a numPositions \a positions to \a normals. See above.
+	static void				computeNormals( const uint32_t *indices, size_t numIndices, const ci::Vec3f *positions, 
+		size_t numPositions, ci::Vec3f *normals, NormalWeight weight = NORMAL_WEIGHT_AREA, uint32_t numThreads = 0 );
+	/*! Returns a tangent for each vertex of \a triMesh for normal mapping, in 
+		MikkTSpace's convention: xyz points where texture coordinate s increases, 
+		made orthogonal to the vertex normal, and w is the bitangent's sign, ie, 
+		bitangent = w * normal.cross( tangent ). Triangles count by their angle at 
+		the vertex. Missing normals are computed first. Vertices whose texture 
+		coordinates don't vary get any tangent orthogonal to the normal. Threads 
+		are used as in computeNormals(), summing in the same fixed order. */
+	static std::vector<ci::Vec4f>	computeTangents( const ci::TriMesh &triMesh, uint32_t numThreads = 0 );
+	//! Write a tangent for each of \a numVertices vertices to \a tangents. See above.
+	static void				computeTangents( const uint32_t *indices, size_t numIndices, const ci::Vec3f *positions, 
+		const ci::Vec3f *normals, const ci::Vec2f *texCoords, size_t numVertices, ci::Vec4f *tangents, 
+		uint32_t numThreads = 0 );
+
+	//! Largest geosphere frequency whose 10 * n^2 + 2 vertices fit 32-bit indices.
+	static const uint32_t	kMaxGeosphereFrequency	= 20724;
+	//! Largest icosahedron division within kMaxGeosphereFrequency.
+	static const uint32_t	kMaxIcosahedronDivision	= 15;
+
+	/*! Generators returning a TriMesh only compute and store the attributes in 
+		\a flags, eg, pass 0 for positions only, and run any OPTIMIZE_ passes it 
+		names. Each generator also has an overload that writes into a MeshBuilder 
+		instead of returning a TriMesh. These return false if the builder's arrays 
+		are too small or the mesh cannot be built, eg, a geosphere past 
+		kMaxGeosphereFrequency. The TriMesh generators return an empty mesh 
+		then. If \a bounds isn't null, it receives the bounds of the exact 
+		surface, worked out from the parameters, which contain the mesh. It is 
+		only written when the mesh is built. */
 
 	//! Create circle TriMesh with a radius of 1.0 and \a resolution segments.
-	static ci::TriMesh		createCircle( const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ) );
+	static ci::TriMesh		createCircle( const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ), uint32_t flags = ATTRIB_ALL, 
+		MeshBounds *bounds = 0 );
+	static bool				createCircle( MeshBuilder &builder, const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ), 
+		MeshBounds *bounds = 0 );
 	//! Create cube TriMesh with an edge length of 1.0 divided into \a resolution segments.
-	static ci::TriMesh		createCube( const ci::Vec3i &resolution = ci::Vec3i::one() );
+	static ci::TriMesh		createCube( const ci::Vec3i &resolution = ci::Vec3i::one(), uint32_t flags = ATTRIB_ALL, 
+		MeshBounds *bounds = 0 );
+	static bool				createCube( MeshBuilder &builder, const ci::Vec3i &resolution = ci::Vec3i::one(), 
+		MeshBounds *bounds = 0 );
 	/*! Create cylinder TriMesh with a height of 1.0, top radius of \a topRadius, base radius 
 		of \a baseRadius and \a resolution segments. Top and base are closed with \a closeTop and 
 		\a closeBase flags. */
 	static ci::TriMesh		createCylinder( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), 
-		float topRadius = 1.0f, float baseRadius = 1.0f, bool closeTop = true, bool closeBase = true );
-	//! Creates icosahedron where each face is subdivided \b division times.
-	static ci::TriMesh		createIcosahedron( uint32_t division = 1 );
+		float topRadius = 1.0f, float baseRadius = 1.0f, bool closeTop = true, bool closeBase = true, 
+		uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	static bool				createCylinder( MeshBuilder &builder, const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), 
+		float topRadius = 1.0f, float baseRadius = 1.0f, bool closeTop = true, bool closeBase = true, 
+		MeshBounds *bounds = 0 );
+	/*! Create cylinder TriMesh as above, writing closed-form tangents for its 
+		vertices to \a tangents. See computeTangents(). */
+	static ci::TriMesh		createCylinder( const ci::Vec2i &resolution, std::vector<ci::Vec4f> &tangents, 
+		float topRadius = 1.0f, float baseRadius = 1.0f, bool closeTop = true, bool closeBase = true, 
+		uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	/*! Create geodesic sphere TriMesh with a radius of 0.5, where each edge of an 
+		icosahedron is split into \a frequency segments. The sphere has exactly 
+		20 * frequency^2 triangles and 10 * frequency^2 + 2 vertices. Frequencies 
+		above kMaxGeosphereFrequency do not fit 32-bit indices, so nothing is 
+		created. */
+	static ci::TriMesh		createGeosphere( uint32_t frequency = 1, uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	static bool				createGeosphere( MeshBuilder &builder, uint32_t frequency = 1, MeshBounds *bounds = 0 );
+	/*! Creates icosahedron where each face is subdivided \b division times. 
+		\a division is clamped to kMaxIcosahedronDivision, the finest that fits 
+		32-bit indices. */
+	static ci::TriMesh		createIcosahedron( uint32_t division = 1, uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	static bool				createIcosahedron( MeshBuilder &builder, uint32_t division = 1, MeshBounds *bounds = 0 );
 	/*! Create ring TriMesh with a radius of 1.0, \a resolution segments, and second radius 
 		of \a ratio. */
 	static ci::TriMesh		createRing( const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ), 
-		float ratio = 0.5f );
+		float ratio = 0.5f, uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	static bool				createRing( MeshBuilder &builder, const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ), 
+		float ratio = 0.5f, MeshBounds *bounds = 0 );
 	//! Create sphere TriMesh with a radius of 1.0 and \a resolution segments.
-	static ci::TriMesh		createSphere( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ) );
+	static ci::TriMesh		createSphere( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), uint32_t flags = ATTRIB_ALL, 
+		MeshBounds *bounds = 0 );
+	static bool				createSphere( MeshBuilder &builder, const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), 
+		MeshBounds *bounds = 0 );
+	//! Create sphere TriMesh with closed-form \a tangents. See computeTangents().
+	static ci::TriMesh		createSphere( const ci::Vec2i &resolution, std::vector<ci::Vec4f> &tangents, 
+		uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
 	//! Create square TriMesh with an edge length of 1.0 divided into \a resolution segments.
-	static ci::TriMesh		createSquare( const ci::Vec2i &resolution = ci::Vec2i::one() );
+	static ci::TriMesh		createSquare( const ci::Vec2i &resolution = ci::Vec2i::one(), uint32_t flags = ATTRIB_ALL, 
+		MeshBounds *bounds = 0 );
+	static bool				createSquare( MeshBuilder &builder, const ci::Vec2i &resolution = ci::Vec2i::one(), 
+		MeshBounds *bounds = 0 );
 	/*! Create torus TriMesh with a radius of 1.0, \a resolution segments, and second radius 
 		of \a ratio. */
 	static ci::TriMesh		createTorus( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), 
-		float ratio = 0.5f );
+		float ratio = 0.5f, uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	static bool				createTorus( MeshBuilder &builder, const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), 
+		float ratio = 0.5f, MeshBounds *bounds = 0 );
+	//! Create torus TriMesh with closed-form \a tangents. See computeTangents().
+	static ci::TriMesh		createTorus( const ci::Vec2i &resolution, std::vector<ci::Vec4f> &tangents, 
+		float ratio = 0.5f, uint32_t flags = ATTRIB_ALL, MeshBounds *bounds = 0 );
+	/*! Create TriMesh from \a surface, any callable taking ( float u, float v ) 
+		and returning a SurfacePoint, sampled on a lattice of \a resolution quads 
+		as u and v run from 0 to 1. Texture coordinates are ( u, v ). Directions 
+		named in \a wrap, eg, PARAMETRIC_WRAP_U, close on themselves: their last 
+		lattice line takes the first line's positions and normals, so the seam is 
+		watertight, but has its own vertices with texture coordinate 1. With 
+		PARAMETRIC_SHARE_SEAMS the last line is the first one instead, which saves 
+		its vertices but wraps texture coordinates from ( n - 1 ) / n back to 0 
+		across the seam. Open edges, including poles, keep a vertex per lattice 
+		point so each has its own texture coordinate. Triangles wind 
+		counterclockwise around dP/dv x dP/du. Meshes of 65536 vertices or more 
+		are evaluated a range of rows per thread on \a numThreads threads, or one 
+		per core if zero, so \a surface must be safe to call concurrently. The 
+		sphere, cylinder and torus are built on the same lattice with their 
+		wrapped seams duplicated. \a bounds is measured from the mesh. */
+	template<typename F>
+	static ci::TriMesh		createParametric( const ci::Vec2i &resolution, F surface, uint32_t wrap = 0, 
+		uint32_t flags = ATTRIB_ALL, uint32_t numThreads = 0, MeshBounds *bounds = 0 );
+	template<typename F>
+	static bool				createParametric( MeshBuilder &builder, const ci::Vec2i &resolution, F surface, 
+		uint32_t wrap = 0, uint32_t numThreads = 0, MeshBounds *bounds = 0 );
+
+	/*! LOD chains with up to \a numLevels levels. Level 0 is the primitive at full 
+		\a resolution and each further level halves it by taking every other lattice 
+		line, so coarser levels add only indices. The chain stops early once a 
+		resolution no longer halves evenly or would fall below the primitive's 
+		minimum. \a flags are as for the generators, except that only 
+		OPTIMIZE_VERTEX_CACHE applies, per level, and ATTRIB_PARENT_POSITION adds 
+		geomorph data. */
+
+	static LodChain			createCylinderLodChain( const ci::Vec2i &resolution = ci::Vec2i( 48, 8 ), 
+		float topRadius = 1.0f, float baseRadius = 1.0f, bool closeTop = true, bool closeBase = true, 
+		uint32_t numLevels = 4, uint32_t flags = ATTRIB_ALL );
+	static LodChain			createGeosphereLodChain( uint32_t frequency = 16, uint32_t numLevels = 4, 
+		uint32_t flags = ATTRIB_ALL );
+	static LodChain			createSphereLodChain( const ci::Vec2i &resolution = ci::Vec2i( 48, 24 ), 
+		uint32_t numLevels = 4, uint32_t flags = ATTRIB_ALL );
+	static LodChain			createTorusLodChain( const ci::Vec2i &resolution = ci::Vec2i( 48, 24 ), 
+		float ratio = 0.5f, uint32_t numLevels = 4, uint32_t flags = ATTRIB_ALL );
+
+	/*! Each generator has a matching query function that returns the exact size of 
+		its output without generating it. Use these to budget memory or allocate 
+		buffers for a MeshBuilder up front. */
+
+	//! Returns size of circle TriMesh with \a resolution segments.
+	static MeshSize			queryCircle( const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ) );
+	//! Returns size of cube TriMesh with \a resolution segments.
+	static MeshSize			queryCube( const ci::Vec3i &resolution = ci::Vec3i::one() );
+	//! Returns size of cylinder TriMesh with \a resolution segments.
+	static MeshSize			queryCylinder( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), 
+		bool closeTop = true, bool closeBase = true );
+	/*! Returns size of geodesic sphere TriMesh with \a frequency segments per edge, 
+		or an empty size if it does not fit 32-bit indices. */
+	static MeshSize			queryGeosphere( uint32_t frequency = 1 );
+	//! Returns size of icosahedron TriMesh subdivided \a division times.
+	static MeshSize			queryIcosahedron( uint32_t division = 1 );
+	//! Returns size of parametric TriMesh with \a resolution quads, wrapped as \a wrap.
+	static MeshSize			queryParametric( const ci::Vec2i &resolution, uint32_t wrap = 0 );
+	//! Returns size of ring TriMesh with \a resolution segments.
+	static MeshSize			queryRing( const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ), float ratio = 0.5f );
+	//! Returns size of sphere TriMesh with \a resolution segments.
+	static MeshSize			querySphere( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ) );
+	//! Returns size of square TriMesh with \a resolution segments.
+	static MeshSize			querySquare( const ci::Vec2i &resolution = ci::Vec2i::one() );
+	/*! Returns size of \a triMesh after subdividing it \a division times. This 
+		counts the mesh's unique edges but does not subdivide it. */
+	static MeshSize			querySubdivide( const ci::TriMesh &triMesh, uint32_t division = 2 );
+	//! Returns size of torus TriMesh with \a resolution segments.
+	static MeshSize			queryTorus( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ) );
+
+	/*! Each generator can also write straight into a user-defined vertex type \a V, 
+		eg, createSphere<MyVertex>(). See VertexTraits. A generator that creates 
+		nothing, eg, a geosphere past kMaxGeosphereFrequency, returns an empty 
+		mesh and leaves \a bounds untouched. */
+
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createCircle( const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ), MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createCube( const ci::Vec3i &resolution = ci::Vec3i::one(), MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createCylinder( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), 
+		float topRadius = 1.0f, float baseRadius = 1.0f, bool closeTop = true, bool closeBase = true, 
+		MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createGeosphere( uint32_t frequency = 1, MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createIcosahedron( uint32_t division = 1, MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createRing( const ci::Vec2i &resolution = ci::Vec2i( 12, 1 ), float ratio = 0.5f, 
+		MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createSphere( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createSquare( const ci::Vec2i &resolution = ci::Vec2i::one(), MeshBounds *bounds = 0 );
+	template<typename V, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createTorus( const ci::Vec2i &resolution = ci::Vec2i( 12, 6 ), float ratio = 0.5f, 
+		MeshBounds *bounds = 0 );
+	template<typename V, typename F, typename Traits = VertexTraits<V> >
+	static VertexMesh<V>	createParametric( const ci::Vec2i &resolution, F surface, uint32_t wrap = 0, 
+		uint32_t numThreads = 0, MeshBounds *bounds = 0 );
+private:
+	//! Bounds of each primitive's exact surface.
+	static MeshBounds		getCubeBounds( const ci::Vec3i &resolution );
+	static MeshBounds		getCylinderBounds( const ci::Vec2i &resolution, float topRadius, float baseRadius );
+	static MeshBounds		getGeosphereBounds();
+	static MeshBounds		getRingBounds( const ci::Vec2i &resolution, float ratio );
+	static MeshBounds		getSphereBounds( const ci::Vec2i &resolution );
+	static MeshBounds		getSquareBounds( const ci::Vec2i &resolution );
+	static MeshBounds		getTorusBounds( const ci::Vec2i &resolution, float ratio );
+
+	//! Shared generator kernels, templated on the destination.
+	template<typename Builder>
+	static bool				buildCube( Builder &builder, const ci::Vec3i &resolution );
+	template<typename Builder>
+	static bool				buildCylinder( Builder &builder, const ci::Vec2i &resolution, float topRadius, 
+		float baseRadius, bool closeTop, bool closeBase );
+	template<typename Builder>
+	static bool				buildGeosphere( Builder &builder, uint32_t frequency );
+	template<typename Builder>
+	static bool				buildRing( Builder &builder, const ci::Vec2i &resolution, float ratio );
+	template<typename Builder>
+	static bool				buildSphere( Builder &builder, const ci::Vec2i &resolution );
+	template<typename Builder>
+	static bool				buildSquare( Builder &builder, const ci::Vec2i &resolution );
+	template<typename Builder>
+	static bool				buildTorus( Builder &builder, const ci::Vec2i &resolution, float ratio );
+	template<typename Builder, typename F>
+	static bool				buildParametric( Builder &builder, const ci::Vec2i &resolution, F surface, uint32_t wrap, 
+		uint32_t numThreads );
+
+	/*! Writes a lattice of \a resolution quads, wrapped as \a wrap, from \a vertex 
+		and \a index on. \a rowWriter( row, vertex ) writes the vertices of each 
+		row. Ranges of rows go to \a numThreads threads as for createParametric(). */
+	template<typename Builder, typename RowWriter>
+	static void				buildLattice( Builder &builder, size_t vertex, size_t index, const ci::Vec2i &resolution, 
+		uint32_t wrap, uint32_t numThreads, RowWriter rowWriter );
+	/*! Calls \a fn( first, last ) on ranges covering \a numRows rows of \a rowSize 
+		vertices, in parallel if there are enough of them. */
+	static void				runRows( size_t numRows, size_t rowSize, uint32_t numThreads, 
+		const std::function<void( size_t, size_t )> &fn );
+	//! Runs the OPTIMIZE_ passes named in \a flags on generated \a triMesh.
+	static void				optimize( ci::TriMesh &triMesh, uint32_t flags );
+	//! Returns the bounds of the vertices written to \a builder.
+	template<typename Builder>
+	static MeshBounds		measureBounds( const Builder &builder );
+	//! Returns the number of lattice lines across \a numQuads quads in \a direction of \a wrap.
+	static size_t			getNumLatticeLines( int32_t numQuads, uint32_t wrap, uint32_t direction )
+	{
+		bool shared = ( wrap & direction ) != 0 && ( wrap & PARAMETRIC_SHARE_SEAMS ) != 0;
+		return (size_t)numQuads + ( shared ? 0 : 1 );
+	}
+
+	//! Projects flat lattice point \a position onto the geosphere and writes it as vertex \a i.
+	template<typename Builder>
+	static void				setGeosphereVertex( Builder &builder, size_t i, const ci::Vec3f &position );
+	//! Returns the three corners of icosahedron face \a face.
+	static const uint32_t*	getGeosphereFace( size_t face );
+	//! Numbers the 30 icosahedron edges, each running from its lower to its upper corner.
+	static void				numberGeosphereEdges( int32_t ( &edgeIds )[ 12 ][ 12 ], uint32_t ( &edgeCorners )[ 30 ][ 2 ] );
+	/*! Fills \a lattice with the vertex at each point of face \a face of a geosphere 
+		with \a frequency, row by row, looking up shared vertices on its corners and edges. */
+	static void				getGeosphereLattice( const int32_t ( &edgeIds )[ 12 ][ 12 ], uint32_t frequency, 
+		uint32_t face, uint32_t *lattice );
+	//! Returns the geosphere vertex \a k steps along the edge from corner \a from to corner \a to.
+	static uint32_t			getGeosphereEdgeVertex( const int32_t ( &edgeIds )[ 12 ][ 12 ], uint32_t edgeBase, 
+		uint32_t perEdge, uint32_t n, uint32_t from, uint32_t to, uint32_t k );
+
+	/*! Writes a square lattice with \a resolution segments into \a builder, 
+		starting at \a vertex and \a index, placed by \a transform. */
+	template<typename Builder>
+	static void				writeSquare( Builder &builder, size_t vertex, size_t index, const ci::Vec2i &resolution, 
+		const ci::Matrix44f &transform, const ci::Vec3f &normal );
 
 /*private:
 
@@ -90,4 +1023,649 @@ public:
 		bool		operator>( const VertexDistance &rhs ) { return mDistance > rhs.mDistance; }
 		bool		operator>=( const VertexDistance &rhs ) { return mDistance >= rhs.mDistance; }
 	};*/
+
 };
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createCircle( const ci::Vec2i &resolution, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildRing( builder, resolution, 0.0f ) && bounds != 0 ) {
+		*bounds = getRingBounds( resolution, 0.0f );
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createCube( const ci::Vec3i &resolution, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildCube( builder, resolution ) && bounds != 0 ) {
+		*bounds = getCubeBounds( resolution );
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createCylinder( const ci::Vec2i &resolution, float topRadius, float baseRadius, 
+	bool closeTop, bool closeBase, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildCylinder( builder, resolution, topRadius, baseRadius, closeTop, closeBase ) && bounds != 0 ) {
+		*bounds = getCylinderBounds( resolution, topRadius, baseRadius );
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createGeosphere( uint32_t frequency, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildGeosphere( builder, frequency ) && bounds != 0 ) {
+		*bounds = getGeosphereBounds();
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createIcosahedron( uint32_t division, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	division = ci::math<uint32_t>::clamp( division, 1, kMaxIcosahedronDivision );
+	if ( buildGeosphere( builder, 1 << ( division - 1 ) ) && bounds != 0 ) {
+		*bounds = getGeosphereBounds();
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createRing( const ci::Vec2i &resolution, float ratio, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildRing( builder, resolution, ratio ) && bounds != 0 ) {
+		*bounds = getRingBounds( resolution, ratio );
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createSphere( const ci::Vec2i &resolution, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildSphere( builder, resolution ) && bounds != 0 ) {
+		*bounds = getSphereBounds( resolution );
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createSquare( const ci::Vec2i &resolution, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildSquare( builder, resolution ) && bounds != 0 ) {
+		*bounds = getSquareBounds( resolution );
+	}
+	return mesh;
+}
+
+template<typename V, typename Traits>
+VertexMesh<V> MeshHelper::createTorus( const ci::Vec2i &resolution, float ratio, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildTorus( builder, resolution, ratio ) && bounds != 0 ) {
+		*bounds = getTorusBounds( resolution, ratio );
+	}
+	return mesh;
+}
+
+template<typename V, typename F, typename Traits>
+VertexMesh<V> MeshHelper::createParametric( const ci::Vec2i &resolution, F surface, uint32_t wrap, 
+	uint32_t numThreads, MeshBounds *bounds )
+{
+	VertexMesh<V> mesh;
+	VertexBuilder<V, Traits> builder( mesh );
+	if ( buildParametric( builder, resolution, surface, wrap, numThreads ) && bounds != 0 ) {
+		*bounds = measureBounds( builder );
+	}
+	return mesh;
+}
+
+template<typename F>
+ci::TriMesh MeshHelper::createParametric( const ci::Vec2i &resolution, F surface, uint32_t wrap, uint32_t flags, 
+	uint32_t numThreads, MeshBounds *bounds )
+{
+	ci::TriMesh mesh;
+	MeshBuilder builder( mesh, flags );
+	if ( !buildParametric( builder, resolution, surface, wrap, numThreads ) ) {
+		return mesh;
+	}
+	optimize( mesh, flags );
+	if ( bounds != 0 ) {
+		*bounds = computeBounds( mesh );
+	}
+	return mesh;
+}
+
+template<typename F>
+bool MeshHelper::createParametric( MeshBuilder &builder, const ci::Vec2i &resolution, F surface, uint32_t wrap, 
+	uint32_t numThreads, MeshBounds *bounds )
+{
+	if ( !buildParametric( builder, resolution, surface, wrap, numThreads ) ) {
+		return false;
+	}
+	if ( bounds != 0 ) {
+		*bounds = measureBounds( builder );
+	}
+	return true;
+}
+
+template<typename Builder>
+void MeshHelper::writeSquare( Builder &builder, size_t vertex, size_t index, const ci::Vec2i &resolution, 
+	const ci::Matrix44f &transform, const ci::Vec3f &normal )
+{
+	if ( resolution.x <= 0 || resolution.y <= 0 ) {
+		return;
+	}
+
+	uint32_t first = (uint32_t)vertex;
+	ci::Vec2f scale( 1.0f / (float)resolution.x, 1.0f / (float)resolution.y );
+	for ( int32_t y = 0; y <= resolution.y; ++y ) {
+		for ( int32_t x = 0; x <= resolution.x; ++x, ++vertex ) {
+			ci::Vec2f texCoord( (float)x * scale.x, (float)y * scale.y );
+
+			builder.setNormal( vertex, normal );
+			builder.setPosition( vertex, transform.transformPoint( ci::Vec3f( texCoord.x - 0.5f, texCoord.y - 0.5f, 0.0f ) ) );
+			builder.setTexCoord( vertex, texCoord );
+		}
+	}
+
+	uint32_t stride = (uint32_t)resolution.x + 1;
+	for ( int32_t y = 0; y < resolution.y; ++y ) {
+		for ( int32_t x = 0; x < resolution.x; ++x, index += 6 ) {
+			uint32_t index0 = first + (uint32_t)y * stride + (uint32_t)x;
+			uint32_t index1 = index0 + 1;
+			uint32_t index2 = index0 + stride;
+			uint32_t index3 = index2 + 1;
+
+			builder.setTriangle( index + 0, index2, index1, index0 );
+			builder.setTriangle( index + 3, index1, index2, index3 );
+		}
+	}
+}
+
+template<typename Builder>
+bool MeshHelper::buildCube( Builder &builder, const ci::Vec3i &resolution )
+{
+	struct Face
+	{
+		ci::Vec3f	mNormal;
+		ci::Vec3f	mRotation;
+		ci::Vec2i	mResolution;
+	};
+
+	float halfPi = (float)M_PI * 0.5f;
+	Face faces[ 6 ] = {
+		{ ci::Vec3f(  0.0f,  0.0f, -1.0f ), ci::Vec3f(   0.0f,    0.0f, 0.0f ), ci::Vec2i( resolution.x, resolution.y ) }, // Back
+		{ ci::Vec3f(  0.0f, -1.0f,  0.0f ), ci::Vec3f( -halfPi,   0.0f, 0.0f ), ci::Vec2i( resolution.x, resolution.z ) }, // Bottom
+		{ ci::Vec3f(  0.0f,  0.0f,  1.0f ), ci::Vec3f(   0.0f,    0.0f, 0.0f ), ci::Vec2i( resolution.x, resolution.y ) }, // Front
+		{ ci::Vec3f( -1.0f,  0.0f,  0.0f ), ci::Vec3f(   0.0f, -halfPi, 0.0f ), ci::Vec2i( resolution.z, resolution.y ) }, // Left
+		{ ci::Vec3f(  1.0f,  0.0f,  0.0f ), ci::Vec3f(   0.0f,  halfPi, 0.0f ), ci::Vec2i( resolution.z, resolution.y ) }, // Right
+		{ ci::Vec3f(  0.0f,  1.0f,  0.0f ), ci::Vec3f(  halfPi,   0.0f, 0.0f ), ci::Vec2i( resolution.x, resolution.z ) }  // Top
+	};
+
+	if ( !builder.allocate( queryCube( resolution ) ) ) {
+		return false;
+	}
+
+	// Each face is a square lattice, so vertices are only 
+	// duplicated along the cube's hard edges
+	size_t vertex	= 0;
+	size_t index	= 0;
+	for ( size_t i = 0; i < 6; ++i ) {
+		const Face &face = faces[ i ];
+		ci::Vec3f offset = face.mNormal * 0.5f;
+
+		ci::Matrix44f transform;
+		transform.translate( offset );
+		if ( face.mRotation != ci::Vec3f::zero() ) {
+			transform.rotate( face.mRotation );
+			transform.translate( offset * -1.0f );
+			transform.translate( offset );
+		}
+		writeSquare( builder, vertex, index, face.mResolution, transform, face.mNormal );
+
+		MeshSize size = querySquare( face.mResolution );
+		vertex	+= size.getNumVertices();
+		index	+= size.getNumIndices();
+	}
+
+	return true;
+}
+
+template<typename Builder>
+bool MeshHelper::buildCylinder( Builder &builder, const ci::Vec2i &resolution, float topRadius, float baseRadius, 
+	bool closeTop, bool closeBase )
+{
+	MeshSize size = queryCylinder( resolution, closeTop, closeBase );
+	if ( !builder.allocate( size ) ) {
+		return false;
+	} else if ( size.getNumVertices() == 0 ) {
+		return true;
+	}
+
+	SinCosTableRef angles	= SinCosTable::get( (uint32_t)resolution.x );
+	const float *cosTheta	= angles->getCos();
+	const float *sinTheta	= angles->getSin();
+	float width				= (float)resolution.x;
+	float height			= (float)resolution.y;
+
+	// The sides' quads follow the top cap's triangles. The closing 
+	// column takes the first column's angle, so the seam is watertight 
+	// while its texture coordinate runs on to 1.
+	size_t sideIndex = closeTop ? (size_t)resolution.x * 3 : 0;
+	buildLattice( builder, 0, sideIndex, resolution, PARAMETRIC_WRAP_U, 0, [ & ]( size_t p, size_t vertex )
+	{
+		float phi		= (float)p / height;
+		float radius	= ci::lerp( baseRadius, topRadius, phi );
+		for ( int32_t t = 0; t <= resolution.x; ++t, ++vertex ) {
+			int32_t k = t < resolution.x ? t : 0;
+			builder.setPosition( vertex, ci::Vec3f( cosTheta[ k ] * radius, phi - 0.5f, sinTheta[ k ] * radius ) );
+			builder.setNormal( vertex, ci::Vec3f( cosTheta[ k ], 0.0f, sinTheta[ k ] ) );
+			builder.setTexCoord( vertex, ci::Vec2f( (float)t / width, phi ) );
+		}
+	} );
+
+	// The caps have a hard edge against the sides, so their 
+	// rim vertices are duplicated with the cap's normal
+	size_t stride	= (size_t)resolution.x + 1;
+	size_t vertex	= stride * (size_t)( resolution.y + 1 );
+	size_t index	= 0;
+	if ( closeTop ) {
+		uint32_t center	= (uint32_t)vertex;
+		uint32_t rim	= (uint32_t)( stride * (size_t)resolution.y );
+		ci::Vec3f normal( 0.0f, -1.0f, 0.0f );
+		ci::Vec2f texCoord( 0.0f, 1.0f );
+		builder.setNormal( vertex, normal );
+		builder.setPosition( vertex, ci::Vec3f( 0.0f, 0.5f, 0.0f ) );
+		builder.setTexCoord( vertex, texCoord );
+		++vertex;
+		for ( int32_t t = 0; t < resolution.x; ++t, ++vertex ) {
+			builder.setNormal( vertex, normal );
+			builder.setPosition( vertex, builder.getPosition( rim + t ) );
+			builder.setTexCoord( vertex, texCoord );
+		}
+
+		for ( int32_t t = 0; t < resolution.x; ++t, index += 3 ) {
+			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+			builder.setTriangle( index, center, center + 1 + (uint32_t)n, center + 1 + (uint32_t)t );
+		}
+	}
+
+	index = sideIndex + (size_t)resolution.x * (size_t)resolution.y * 6;
+	if ( closeBase ) {
+		uint32_t center	= (uint32_t)vertex;
+		ci::Vec3f normal( 0.0f, 1.0f, 0.0f );
+		ci::Vec2f texCoord( 0.0f, 0.0f );
+		builder.setNormal( vertex, normal );
+		builder.setPosition( vertex, ci::Vec3f( 0.0f, -0.5f, 0.0f ) );
+		builder.setTexCoord( vertex, texCoord );
+		++vertex;
+		for ( int32_t t = 0; t < resolution.x; ++t, ++vertex ) {
+			builder.setNormal( vertex, normal );
+			builder.setPosition( vertex, builder.getPosition( t ) );
+			builder.setTexCoord( vertex, texCoord );
+		}
+
+		for ( int32_t t = 0; t < resolution.x; ++t, index += 3 ) {
+			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+			builder.setTriangle( index, center, center + 1 + (uint32_t)n, center + 1 + (uint32_t)t );
+		}
+	}
+
+	return true;
+}
+
+template<typename Builder>
+bool MeshHelper::buildGeosphere( Builder &builder, uint32_t frequency )
+{
+	const float t	= 0.5f + 0.5f * ci::math<float>::sqrt( 5.0f );
+	const float one	= 1.0f / ci::math<float>::sqrt( 1.0f + t * t );
+	const float tau	= t * one;
+
+	const ci::Vec3f corners[ 12 ] = {
+		ci::Vec3f(  one, 0.0f,  tau ), 
+		ci::Vec3f(  one, 0.0f, -tau ), 
+		ci::Vec3f( -one, 0.0f, -tau ), 
+		ci::Vec3f( -one, 0.0f,  tau ), 
+
+		ci::Vec3f(  tau,  one, 0.0f ), 
+		ci::Vec3f( -tau,  one, 0.0f ), 
+		ci::Vec3f( -tau, -one, 0.0f ), 
+		ci::Vec3f(  tau, -one, 0.0f ), 
+
+		ci::Vec3f( 0.0f,  tau,  one ), 
+		ci::Vec3f( 0.0f, -tau,  one ), 
+		ci::Vec3f( 0.0f, -tau, -one ), 
+		ci::Vec3f( 0.0f,  tau, -one )
+	};
+
+	static const size_t numFaces	= 20;
+	static const uint32_t numEdges	= 30;
+	int32_t edgeIds[ 12 ][ 12 ];
+	uint32_t edgeCorners[ numEdges ][ 2 ];
+	numberGeosphereEdges( edgeIds, edgeCorners );
+
+	// Corners come first, then the inside of each edge, then the inside 
+	// of each face, so every shared vertex is written exactly once
+	uint32_t n				= ci::math<uint32_t>::max( frequency, 1 );
+	uint32_t perEdge		= n - 1;
+	uint32_t perFace		= n > 2 ? ( n - 1 ) * ( n - 2 ) / 2 : 0;
+	uint32_t edgeBase		= 12;
+	uint32_t faceBase		= edgeBase + numEdges * perEdge;
+	float scale				= 1.0f / (float)n;
+
+	// Too many vertices for 32-bit indices
+	MeshSize size = queryGeosphere( frequency );
+	if ( size.getNumVertices() == 0 || !builder.allocate( size ) ) {
+		return false;
+	}
+
+	// Each lattice point is projected onto the sphere as it is written
+	for ( uint32_t i = 0; i < 12; ++i ) {
+		setGeosphereVertex( builder, i, corners[ i ] );
+	}
+	for ( uint32_t e = 0; e < numEdges; ++e ) {
+		const ci::Vec3f &a = corners[ edgeCorners[ e ][ 0 ] ];
+		const ci::Vec3f &b = corners[ edgeCorners[ e ][ 1 ] ];
+		for ( uint32_t k = 1; k < n; ++k ) {
+			setGeosphereVertex( builder, edgeBase + e * perEdge + k - 1, ( a * (float)( n - k ) + b * (float)k ) * scale );
+		}
+	}
+	for ( uint32_t f = 0; f < numFaces; ++f ) {
+		const uint32_t *face = getGeosphereFace( f );
+		const ci::Vec3f &a = corners[ face[ 0 ] ];
+		const ci::Vec3f &b = corners[ face[ 1 ] ];
+		const ci::Vec3f &c = corners[ face[ 2 ] ];
+		uint32_t index = faceBase + f * perFace;
+		for ( uint32_t j = 1; j + 1 < n; ++j ) {
+			for ( uint32_t i = 1; i + j < n; ++i, ++index ) {
+				setGeosphereVertex( builder, index, ( a * (float)( n - i - j ) + b * (float)i + c * (float)j ) * scale );
+			}
+		}
+	}
+
+	// Walk each face's lattice in rows
+	std::vector<uint32_t> lattice( ( n + 1 ) * ( n + 2 ) / 2 );
+	size_t index = 0;
+	for ( uint32_t f = 0; f < numFaces; ++f ) {
+		getGeosphereLattice( edgeIds, n, f, &lattice[ 0 ] );
+
+		const uint32_t *bottom = &lattice[ 0 ];
+		for ( uint32_t j = 0; j < n; ++j ) {
+			const uint32_t *top = bottom + n - j + 1;
+			for ( uint32_t i = 0; i + j < n; ++i ) {
+				builder.setTriangle( index, bottom[ i ], bottom[ i + 1 ], top[ i ] );
+				index += 3;
+				if ( i + j + 1 < n ) {
+					builder.setTriangle( index, bottom[ i + 1 ], top[ i + 1 ], top[ i ] );
+					index += 3;
+				}
+			}
+			bottom = top;
+		}
+	}
+
+	return true;
+}
+
+template<typename Builder>
+void MeshHelper::setGeosphereVertex( Builder &builder, size_t i, const ci::Vec3f &position )
+{
+	ci::Vec3f normal = position.normalized();
+	builder.setNormal( i, normal );
+	builder.setPosition( i, normal * 0.5f );
+	if ( builder.hasTexCoords() ) {
+		builder.setTexCoord( i, ci::Vec2f( 
+			0.5f + 0.5f * ci::math<float>::atan2( normal.x, normal.z ) / (float)M_PI, 
+			0.5f - ci::math<float>::asin( normal.y ) / (float)M_PI 
+			) );
+	}
+}
+
+template<typename Builder>
+bool MeshHelper::buildRing( Builder &builder, const ci::Vec2i &resolution, float ratio )
+{
+	// A ring with no inner radius (ie, a circle) collapses 
+	// its inner row into a single center vertex
+	bool closed		= ratio <= 0.0f;
+	MeshSize size	= queryRing( resolution, ratio );
+	if ( !builder.allocate( size ) ) {
+		return false;
+	} else if ( size.getNumVertices() == 0 ) {
+		return true;
+	}
+
+	ci::Vec3f norm0( 0.0f, 0.0f, 1.0f );
+
+	SinCosTableRef angles	= SinCosTable::get( (uint32_t)resolution.x );
+	const float *cosTheta	= angles->getCos();
+	const float *sinTheta	= angles->getSin();
+	float width				= 1.0f - ratio;
+	float step				= width / (float)resolution.y;
+
+	size_t vertex = 0;
+	if ( closed ) {
+		builder.setNormal( vertex, norm0 );
+		builder.setPosition( vertex, ci::Vec3f::zero() );
+		builder.setTexCoord( vertex, ci::Vec2f::one() * 0.5f );
+		++vertex;
+	}
+
+	for ( int32_t p = closed ? 1 : 0; p <= resolution.y; ++p, vertex += resolution.x ) {
+		float radius = ratio + (float)p * step;
+		for ( int32_t t = 0; t < resolution.x; ++t ) {
+			ci::Vec3f position( cosTheta[ t ] * radius, sinTheta[ t ] * radius, 0.0f );
+			builder.setNormal( vertex + t, norm0 );
+			builder.setPosition( vertex + t, position );
+			builder.setTexCoord( vertex + t, ( position.xy() + ci::Vec2f::one() ) * 0.5f );
+		}
+	}
+
+	size_t index	= 0;
+	uint32_t first	= closed ? 1 : 0;
+	for ( int32_t p = 0; p < resolution.y; ++p ) {
+		uint32_t a = first + (uint32_t)( ( p - (int32_t)first ) * resolution.x );
+		uint32_t b = first + (uint32_t)( ( p + 1 - (int32_t)first ) * resolution.x );
+		for ( int32_t t = 0; t < resolution.x; ++t ) {
+			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+
+			uint32_t index1 = closed && p == 0 ? 0 : a + n;
+			uint32_t index2 = b + t;
+			uint32_t index3 = b + n;
+
+			// The inner triangle of a circle's center row has no area
+			if ( !closed || p > 0 ) {
+				builder.setTriangle( index, a + t, index2, index1 );
+				index += 3;
+			}
+			builder.setTriangle( index, index1, index2, index3 );
+			index += 3;
+		}
+	}
+
+	return true;
+}
+
+template<typename Builder>
+bool MeshHelper::buildSphere( Builder &builder, const ci::Vec2i &resolution )
+{
+	MeshSize size = querySphere( resolution );
+	if ( !builder.allocate( size ) ) {
+		return false;
+	} else if ( size.getNumVertices() == 0 ) {
+		return true;
+	}
+
+	// Latitude runs half a turn, so it takes every angle of a table with 
+	// twice as many segments
+	SinCosTableRef longitude	= SinCosTable::get( (uint32_t)resolution.x );
+	SinCosTableRef latitude		= SinCosTable::get( (uint32_t)resolution.y * 2 );
+	const float *cosTheta		= longitude->getCos();
+	const float *sinTheta		= longitude->getSin();
+
+	buildLattice( builder, 0, 0, resolution, PARAMETRIC_WRAP_U, 0, [ & ]( size_t p, size_t vertex )
+	{
+		float sinPhi	= latitude->getSin( p );
+		float z			= -latitude->getCos( p );
+
+		// Columns start one step around, and the closing column repeats 
+		// the first. The position is already unit length, so it is the 
+		// normal. Texture coordinates are projected from it.
+		for ( int32_t t = 0; t <= resolution.x; ++t, ++vertex ) {
+			int32_t k = t < resolution.x ? t + 1 : 1;
+			ci::Vec3f position( sinPhi * cosTheta[ k ], sinPhi * sinTheta[ k ], z );
+			builder.setNormal( vertex, position );
+			builder.setPosition( vertex, position );
+			builder.setTexCoord( vertex, ( position.xy() + ci::Vec2f::one() ) * 0.5f );
+		}
+	} );
+
+	return true;
+}
+
+template<typename Builder>
+bool MeshHelper::buildSquare( Builder &builder, const ci::Vec2i &resolution )
+{
+	if ( !builder.allocate( querySquare( resolution ) ) ) {
+		return false;
+	}
+
+	writeSquare( builder, 0, 0, resolution, ci::Matrix44f(), ci::Vec3f( 0.0f, 0.0f, 1.0f ) );
+	return true;
+}
+
+template<typename Builder>
+bool MeshHelper::buildTorus( Builder &builder, const ci::Vec2i &resolution, float ratio )
+{
+	MeshSize size = queryTorus( resolution );
+	if ( !builder.allocate( size ) ) {
+		return false;
+	} else if ( size.getNumVertices() == 0 ) {
+		return true;
+	}
+
+	SinCosTableRef tube		= SinCosTable::get( (uint32_t)resolution.y );
+	SinCosTableRef ring		= SinCosTable::get( (uint32_t)resolution.x );
+	const float *cosTheta	= tube->getCos();
+	const float *sinTheta	= tube->getSin();
+	float width				= (float)resolution.y;
+	float height			= (float)resolution.x;
+
+	float outerRadius	= 0.5f / (1.0f + ratio);
+	float innerRadius	= outerRadius * ratio;
+	
+	// Rows run around the ring and columns around the tube, both closed 
+	// by a line that takes the first one's angle
+	ci::Vec2i lattice( resolution.y, resolution.x );
+	buildLattice( builder, 0, 0, lattice, PARAMETRIC_WRAP_U | PARAMETRIC_WRAP_V, 0, [ & ]( size_t p, size_t vertex )
+	{
+		// The ring starts half a turn around, ie, at cos( phi - pi )
+		size_t j		= p < (size_t)resolution.x ? p : 0;
+		float cosPhi	= -ring->getCos( j );
+		float sinPhi	= -ring->getSin( j );
+		float v			= (float)p / height;
+		for ( int32_t t = 0; t <= resolution.y; ++t, ++vertex ) {
+			int32_t k = t < resolution.y ? t : 0;
+			float rct = outerRadius + innerRadius * cosTheta[ k ];
+			builder.setNormal( vertex, ci::Vec3f( cosPhi * cosTheta[ k ], sinPhi * cosTheta[ k ], sinTheta[ k ] ) );
+			builder.setPosition( vertex, ci::Vec3f( cosPhi * rct, sinPhi * rct, sinTheta[ k ] * innerRadius ) );
+			builder.setTexCoord( vertex, ci::Vec2f( (float)t / width, v ) );
+		}
+	} );
+
+	return true;
+}
+
+template<typename Builder, typename F>
+bool MeshHelper::buildParametric( Builder &builder, const ci::Vec2i &resolution, F surface, uint32_t wrap, 
+	uint32_t numThreads )
+{
+	MeshSize size = queryParametric( resolution, wrap );
+	if ( !builder.allocate( size ) ) {
+		return false;
+	} else if ( size.getNumVertices() == 0 ) {
+		return true;
+	}
+
+	size_t numColumns	= getNumLatticeLines( resolution.x, wrap, PARAMETRIC_WRAP_U );
+	bool wrapU			= ( wrap & PARAMETRIC_WRAP_U ) != 0;
+	bool wrapV			= ( wrap & PARAMETRIC_WRAP_V ) != 0;
+	float width			= (float)resolution.x;
+	float height		= (float)resolution.y;
+	buildLattice( builder, 0, 0, resolution, wrap, numThreads, [ & ]( size_t p, size_t vertex )
+	{
+		// A wrapped seam's closing line is evaluated at 0, 
+		// so it matches the first line exactly
+		float v		= (float)p / height;
+		float sv	= wrapV && p == (size_t)resolution.y ? 0.0f : v;
+		for ( size_t t = 0; t < numColumns; ++t, ++vertex ) {
+			float u				= (float)t / width;
+			SurfacePoint point	= surface( wrapU && t == (size_t)resolution.x ? 0.0f : u, sv );
+			builder.setNormal( vertex, point.mNormal );
+			builder.setPosition( vertex, point.mPosition );
+			builder.setTexCoord( vertex, ci::Vec2f( u, v ) );
+		}
+	} );
+
+	return true;
+}
+
+template<typename Builder, typename RowWriter>
+void MeshHelper::buildLattice( Builder &builder, size_t vertex, size_t index, const ci::Vec2i &resolution, 
+	uint32_t wrap, uint32_t numThreads, RowWriter rowWriter )
+{
+	// A shared seam has one lattice line fewer, and quads 
+	// across it wrap to the first line
+	size_t numColumns	= getNumLatticeLines( resolution.x, wrap, PARAMETRIC_WRAP_U );
+	size_t numRows		= getNumLatticeLines( resolution.y, wrap, PARAMETRIC_WRAP_V );
+	size_t numQuads		= (size_t)resolution.x;
+	size_t numQuadRows	= (size_t)resolution.y;
+	runRows( numRows, numColumns, numThreads, [ & ]( size_t first, size_t last )
+	{
+		for ( size_t p = first; p < last; ++p ) {
+			rowWriter( p, vertex + p * numColumns );
+
+			// Each row starts the quads up to the next one, 
+			// except an open lattice's last row
+			if ( p < numQuadRows ) {
+				uint32_t a = (uint32_t)( vertex + p * numColumns );
+				uint32_t b = (uint32_t)( vertex + ( p + 1 >= numRows ? 0 : p + 1 ) * numColumns );
+				size_t i = index + p * numQuads * 6;
+				for ( uint32_t t = 0; t < (uint32_t)numQuads; ++t, i += 6 ) {
+					uint32_t n = t + 1 >= (uint32_t)numColumns ? 0 : t + 1;
+					builder.setTriangle( i + 0, a + t, b + t, a + n );
+					builder.setTriangle( i + 3, a + n, b + t, b + n );
+				}
+			}
+		}
+	} );
+}
+
+template<typename Builder>
+MeshBounds MeshHelper::measureBounds( const Builder &builder )
+{
+	std::vector<ci::Vec3f> positions( builder.getNumVertices() );
+	for ( size_t i = 0; i < positions.size(); ++i ) {
+		positions[ i ] = builder.getPosition( i );
+	}
+	return computeBounds( positions.empty() ? 0 : &positions[ 0 ], positions.size() );
+}
@@ -0,0 +1,1303 @@
+/*
+* Copyright (c) 2012, Ban the Rewind
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or
+* without modification, are permitted provided that the following
+* conditions are met:
+*
+* Redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in
+* the documentation and/or other materials provided with the
+* distribution.
+*
+* Neither the name of the Ban the Rewind nor the names of its
+* contributors may be used to endorse or promote products
+* derived from this software without specific prior written
+* permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+* STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+* ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+/*
+* Standalone checks for MeshHelper. Build it with the samples' compiler
+* settings and Cinder include path, together with src/MeshHelper.cpp, eg:
+*
+*   g++ -std=c++11 -O2 -I<cinder>/include -I../src MeshHelperTest.cpp
+*       ../src/MeshHelper.cpp -L<cinder>/lib -lcinder -lpthread
+*
+* It prints each failed check and returns non-zero if any failed.
+*/
+
+#include "MeshHelper.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+static int sNumFailures = 0;
+
+static void check( bool condition, const char *name, const char *what )
+{
+	if ( !condition ) {
+		printf( "FAILED %s: %s\n", name, what );
+		++sNumFailures;
+	}
+}
+
+// One triangle corner, as it reaches the rasterizer
+struct Corner
+{
+	Vec3f	mNormal;
+	Vec3f	mPosition;
+	Vec2f	mTexCoord;
+};
+
+struct Triangle
+{
+	Corner	mCorners[ 3 ];
+};
+
+typedef vector<Triangle> TriangleList;
+
+// Vertex type for the VertexMesh generators
+struct Vertex
+{
+	Vec3f	mNormal;
+	Vec3f	mPosition;
+	Vec2f	mTexCoord;
+};
+
+static void addTriangle( TriangleList &triangles, const Corner &a, const Corner &b, const Corner &c )
+{
+	Triangle triangle = { { a, b, c } };
+	triangles.push_back( triangle );
+}
+
+static Corner makeCorner( const Vec3f &position, const Vec3f &normal, const Vec2f &texCoord )
+{
+	Corner corner = { normal, position, texCoord };
+	return corner;
+}
+
+// Unrolls the triangles of an indexed mesh
+static TriangleList unroll( const TriMesh &mesh )
+{
+	TriangleList triangles;
+	const vector<uint32_t> &indices = mesh.getIndices();
+	for ( size_t i = 0; i + 2 < indices.size(); i += 3 ) {
+		Triangle triangle;
+		for ( size_t j = 0; j < 3; ++j ) {
+			uint32_t index = indices[ i + j ];
+			triangle.mCorners[ j ] = makeCorner( mesh.getVertices()[ index ], mesh.getNormals()[ index ],
+				mesh.getTexCoords()[ index ] );
+		}
+		triangles.push_back( triangle );
+	}
+	return triangles;
+}
+
+/*
+* The generators as they were before indexed output, unrolled into
+* one entry per triangle corner. Index lists which were only 0..n-1
+* are folded into the corner order.
+*/
+namespace baseline {
+
+static TriangleList createSquare( const Vec2i &resolution, const Matrix44f &transform = Matrix44f(),
+	const Vec3f &normal = Vec3f( 0.0f, 0.0f, 1.0f ) )
+{
+	TriangleList triangles;
+	Vec2f scale( 1.0f / math<float>::max( (float)resolution.x, 1.0f ), 1.0f / math<float>::max( (float)resolution.y, 1.0f ) );
+	for ( int32_t y = 0; y < resolution.y; ++y ) {
+		for ( int32_t x = 0; x < resolution.x; ++x ) {
+			float x1 = (float)x * scale.x;
+			float y1 = (float)y * scale.y;
+			float x2 = (float)( x + 1 ) * scale.x;
+			float y2 = (float)( y + 1 ) * scale.y;
+
+			Corner c0 = makeCorner( transform.transformPoint( Vec3f( x1 - 0.5f, y1 - 0.5f, 0.0f ) ), normal, Vec2f( x1, y1 ) );
+			Corner c1 = makeCorner( transform.transformPoint( Vec3f( x2 - 0.5f, y1 - 0.5f, 0.0f ) ), normal, Vec2f( x2, y1 ) );
+			Corner c2 = makeCorner( transform.transformPoint( Vec3f( x1 - 0.5f, y2 - 0.5f, 0.0f ) ), normal, Vec2f( x1, y2 ) );
+			Corner c3 = makeCorner( transform.transformPoint( Vec3f( x2 - 0.5f, y2 - 0.5f, 0.0f ) ), normal, Vec2f( x2, y2 ) );
+			addTriangle( triangles, c2, c1, c0 );
+			addTriangle( triangles, c1, c2, c3 );
+		}
+	}
+	return triangles;
+}
+
+static TriangleList createCube( const Vec3i &resolution )
+{
+	struct Face
+	{
+		Vec3f	mNormal;
+		Vec3f	mRotation;
+		Vec2i	mResolution;
+	};
+
+	float halfPi = (float)M_PI * 0.5f;
+	Face faces[ 6 ] = {
+		{ Vec3f(  0.0f,  0.0f, -1.0f ), Vec3f(   0.0f,    0.0f, 0.0f ), Vec2i( resolution.x, resolution.y ) },
+		{ Vec3f(  0.0f, -1.0f,  0.0f ), Vec3f( -halfPi,   0.0f, 0.0f ), Vec2i( resolution.x, resolution.z ) },
+		{ Vec3f(  0.0f,  0.0f,  1.0f ), Vec3f(   0.0f,    0.0f, 0.0f ), Vec2i( resolution.x, resolution.y ) },
+		{ Vec3f( -1.0f,  0.0f,  0.0f ), Vec3f(   0.0f, -halfPi, 0.0f ), Vec2i( resolution.z, resolution.y ) },
+		{ Vec3f(  1.0f,  0.0f,  0.0f ), Vec3f(   0.0f,  halfPi, 0.0f ), Vec2i( resolution.z, resolution.y ) },
+		{ Vec3f(  0.0f,  1.0f,  0.0f ), Vec3f(  halfPi,   0.0f, 0.0f ), Vec2i( resolution.x, resolution.z ) }
+	};
+
+	TriangleList triangles;
+	for ( size_t i = 0; i < 6; ++i ) {
+		Vec3f offset = faces[ i ].mNormal * 0.5f;
+		Matrix44f transform;
+		transform.translate( offset );
+		if ( faces[ i ].mRotation != Vec3f::zero() ) {
+			transform.rotate( faces[ i ].mRotation );
+			transform.translate( offset * -1.0f );
+			transform.translate( offset );
+		}
+		TriangleList face = createSquare( faces[ i ].mResolution, transform, faces[ i ].mNormal );
+		triangles.insert( triangles.end(), face.begin(), face.end() );
+	}
+	return triangles;
+}
+
+static TriangleList createCylinder( const Vec2i &resolution, float topRadius, float baseRadius, bool closeTop,
+	bool closeBase )
+{
+	vector<Corner> src;
+	float delta = ( 2.0f * (float)M_PI ) / (float)resolution.x;
+	float step	= 1.0f / (float)resolution.y;
+	float ud	= 1.0f / (float)resolution.x;
+
+	int32_t p = 0;
+	for ( float phi = 0.0f; p <= resolution.y; ++p, phi += step ) {
+		int32_t t	= 0;
+		float u		= 0.0f;
+		for ( float theta = 0.0f; t < resolution.x; ++t, u += ud, theta += delta ) {
+			float radius = lerp( baseRadius, topRadius, phi );
+			Vec3f position( math<float>::cos( theta ) * radius, phi - 0.5f, math<float>::sin( theta ) * radius );
+			Vec3f normal = Vec3f( position.x, 0.0f, position.z ).normalized();
+			src.push_back( makeCorner( position, normal, Vec2f( u, phi ) ) );
+		}
+	}
+	Corner bottomCenter	= makeCorner( Vec3f( 0.0f, -0.5f, 0.0f ), Vec3f( 0.0f, 1.0f, 0.0f ), Vec2f( 0.0f, 0.0f ) );
+	Corner topCenter	= makeCorner( Vec3f( 0.0f, 0.5f, 0.0f ), Vec3f( 0.0f, -1.0f, 0.0f ), Vec2f( 0.0f, 1.0f ) );
+
+	TriangleList triangles;
+	if ( closeTop ) {
+		for ( int32_t t = 0; t < resolution.x; ++t ) {
+			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+			Corner rimN = topCenter;
+			Corner rimT = topCenter;
+			rimN.mPosition = src[ resolution.x * resolution.y + n ].mPosition;
+			rimT.mPosition = src[ resolution.x * resolution.y + t ].mPosition;
+			addTriangle( triangles, topCenter, rimN, rimT );
+		}
+	}
+	for ( int32_t p = 0; p < resolution.y; ++p ) {
+		for ( int32_t t = 0; t < resolution.x; ++t ) {
+			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+			const Corner &c0 = src[ ( p + 0 ) * resolution.x + t ];
+			const Corner &c1 = src[ ( p + 0 ) * resolution.x + n ];
+			const Corner &c2 = src[ ( p + 1 ) * resolution.x + t ];
+			const Corner &c3 = src[ ( p + 1 ) * resolution.x + n ];
+			addTriangle( triangles, c0, c2, c1 );
+			addTriangle( triangles, c1, c2, c3 );
+		}
+	}
+	if ( closeBase ) {
+		for ( int32_t t = 0; t < resolution.x; ++t ) {
+			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+			Corner rimN = bottomCenter;
+			Corner rimT = bottomCenter;
+			rimN.mPosition = src[ n ].mPosition;
+			rimT.mPosition = src[ t ].mPosition;
+			addTriangle( triangles, bottomCenter, rimN, rimT );
+		}
+	}
+	return triangles;
+}
+
+static TriangleList createRing( const Vec2i &resolution, float ratio )
+{
+	Vec3f norm0( 0.0f, 0.0f, 1.0f );
+	float delta = ( (float)M_PI * 2.0f ) / (float)resolution.x;
+	float width	= 1.0f - ratio;
+	float step	= width / (float)resolution.y;
+
+	TriangleList triangles;
+	int32_t p = 0;
+	for ( float phi = 0.0f; p < resolution.y; ++p, phi += step ) {
+		float innerRadius = phi + 0.0f + ratio;
+		float outerRadius = phi + step + ratio;
+
+		int32_t t = 0;
+		for ( float theta = 0.0f; t < resolution.x; ++t, theta += delta ) {
+			float ct	= math<float>::cos( theta );
+			float st	= math<float>::sin( theta );
+			float ctn	= math<float>::cos( theta + delta );
+			float stn	= math<float>::sin( theta + delta );
+			if ( t >= resolution.x - 1 ) {
+				ctn = 1.0f;
+				stn = 0.0f;
+			}
+
+			Vec3f pos0 = Vec3f( ct, st, 0.0f ) * innerRadius;
+			Vec3f pos1 = Vec3f( ctn, stn, 0.0f ) * innerRadius;
+			Vec3f pos2 = Vec3f( ct, st, 0.0f ) * outerRadius;
+			Vec3f pos3 = Vec3f( ctn, stn, 0.0f ) * outerRadius;
+
+			Corner c0 = makeCorner( pos0, norm0, ( pos0.xy() + Vec2f::one() ) * 0.5f );
+			Corner c1 = makeCorner( pos1, norm0, ( pos1.xy() + Vec2f::one() ) * 0.5f );
+			Corner c2 = makeCorner( pos2, norm0, ( pos2.xy() + Vec2f::one() ) * 0.5f );
+			Corner c3 = makeCorner( pos3, norm0, ( pos3.xy() + Vec2f::one() ) * 0.5f );
+			addTriangle( triangles, c0, c2, c1 );
+			addTriangle( triangles, c1, c2, c3 );
+		}
+	}
+	return triangles;
+}
+
+static TriangleList createIcosahedron()
+{
+	const float t	= 0.5f + 0.5f * math<float>::sqrt( 5.0f );
+	const float one	= 1.0f / math<float>::sqrt( 1.0f + t * t );
+	const float tau	= t * one;
+	const float pi	= (float)M_PI;
+
+	Vec3f normals[ 12 ] = {
+		Vec3f(  one, 0.0f,  tau ), Vec3f(  one, 0.0f, -tau ), Vec3f( -one, 0.0f, -tau ), Vec3f( -one, 0.0f,  tau ),
+		Vec3f(  tau,  one, 0.0f ), Vec3f( -tau,  one, 0.0f ), Vec3f( -tau, -one, 0.0f ), Vec3f(  tau, -one, 0.0f ),
+		Vec3f( 0.0f,  tau,  one ), Vec3f( 0.0f, -tau,  one ), Vec3f( 0.0f, -tau, -one ), Vec3f( 0.0f,  tau, -one )
+	};
+	static const uint32_t indices[ 60 ] = {
+		0, 8, 3,	0, 3, 9,
+		1, 2, 11,	1, 10, 2,
+		4, 0, 7,	4, 7, 1,
+		6, 3, 5,	6, 5, 2,
+		8, 4, 11,	8, 11, 5,
+		9, 10, 7,	9, 6, 10,
+		8, 0, 4,	11, 4, 1,
+		0, 9, 7,	1, 7, 10,
+		3, 8, 5,	2, 5, 11,
+		3, 6, 9,	2, 10, 6
+	};
+
+	vector<Corner> src;
+	for ( size_t i = 0; i < 12; ++i ) {
+		float u = 0.5f + 0.5f * math<float>::atan2( normals[ i ].x, normals[ i ].z ) / pi;
+		float v = 0.5f - math<float>::asin( normals[ i ].y ) / pi;
+		src.push_back( makeCorner( normals[ i ] * 0.5f, normals[ i ], Vec2f( u, v ) ) );
+	}
+
+	TriangleList triangles;
+	for ( size_t i = 0; i < 60; i += 3 ) {
+		addTriangle( triangles, src[ indices[ i ] ], src[ indices[ i + 1 ] ], src[ indices[ i + 2 ] ] );
+	}
+	return triangles;
+}
+
+// The baseline sphere's index list dropped every index past the last
+// row, which left one degenerate triangle per quad of the last row.
+// Those draw nothing, so only full quads are kept here.
+static TriangleList createSphere( const Vec2i &resolution )
+{
+	vector<Corner> src;
+	float step	= (float)M_PI / (float)resolution.y;
+	float delta	= ( (float)M_PI * 2.0f ) / (float)resolution.x;
+
+	int32_t p = 0;
+	for ( float phi = 0.0f; p <= resolution.y; p++, phi += step ) {
+		int32_t t = 0;
+		for ( float theta = delta; t < resolution.x; t++, theta += delta ) {
+			float sinPhi = math<float>::sin( phi );
+			Vec3f position( sinPhi * math<float>::cos( theta ), sinPhi * math<float>::sin( theta ), -math<float>::cos( phi ) );
+			Vec3f normal = position.normalized();
+			src.push_back( makeCorner( position, normal, ( normal.xy() + Vec2f::one() ) * 0.5f ) );
+		}
+	}
+
+	TriangleList triangles;
+	for ( p = 0; p < resolution.y; ++p ) {
+		int32_t a = ( p + 0 ) * resolution.x;
+		int32_t b = ( p + 1 ) * resolution.x;
+		for ( int32_t t = 0; t < resolution.x; ++t ) {
+			int32_t n = t + 1 >= resolution.x ? 0 : t + 1;
+			addTriangle( triangles, src[ a + t ], src[ b + t ], src[ a + n ] );
+			addTriangle( triangles, src[ a + n ], src[ b + t ], src[ b + n ] );
+		}
+	}
+	return triangles;
+}
+
+// The baseline torus normal was wrong, so torus normals are not compared.
+static TriangleList createTorus( const Vec2i &resolution, float ratio )
+{
+	vector<Corner> src;
+	float pi			= (float)M_PI;
+	float delta			= ( 2.0f * pi ) / (float)resolution.y;
+	float step			= ( 2.0f * pi ) / (float)resolution.x;
+	float ud			= 1.0f / (float)resolution.y;
+	float vd			= 1.0f / (float)resolution.x;
+	float outerRadius	= 0.5f / ( 1.0f + ratio );
+	float innerRadius	= outerRadius * ratio;
+
+	int32_t p	= 0;
+	float v		= 0.0f;
+	for ( float phi = 0.0f; p < resolution.x; ++p, v += vd, phi += step ) {
+		float cosPhi = math<float>::cos( phi - pi );
+		float sinPhi = math<float>::sin( phi - pi );
+
+		int32_t t	= 0;
+		float u		= 0.0f;
+		for ( float theta = 0.0f; t < resolution.y; ++t, u += ud, theta += delta ) {
+			float cosTheta	= math<float>::cos( theta );
+			float sinTheta	= math<float>::sin( theta );
+			float rct		= outerRadius + innerRadius * cosTheta;
+			src.push_back( makeCorner( Vec3f( cosPhi * rct, sinPhi * rct, sinTheta * innerRadius ), Vec3f::zero(), Vec2f( u, v ) ) );
+		}
+	}
+
+	TriangleList triangles;
+	for ( p = 0; p < resolution.x; ++p ) {
+		int32_t a = ( p + 0 ) * resolution.y;
+		int32_t b = ( p + 1 >= resolution.x ? 0 : p + 1 ) * resolution.y;
+		for ( int32_t t = 0; t < resolution.y; ++t ) {
+			int32_t n = t + 1 >= resolution.y ? 0 : t + 1;
+			addTriangle( triangles, src[ a + t ], src[ b + t ], src[ a + n ] );
+			addTriangle( triangles, src[ a + n ], src[ b + t ], src[ b + n ] );
+		}
+	}
+	return triangles;
+}
+
+}
+
+static const float kTolerance = 1e-5f;
+
+static bool isDegenerate( const Triangle &triangle )
+{
+	const Vec3f &a = triangle.mCorners[ 0 ].mPosition;
+	const Vec3f &b = triangle.mCorners[ 1 ].mPosition;
+	const Vec3f &c = triangle.mCorners[ 2 ].mPosition;
+	return ( b - a ).cross( c - a ).lengthSquared() <= kTolerance * kTolerance;
+}
+
+// The baseline wrapped texture coordinates back to 0 across seams, where 
+// the generators now close them at 1, so these compare modulo 1
+static bool matches( const Corner &a, const Corner &b, bool normals )
+{
+	Vec2f delta = a.mTexCoord - b.mTexCoord;
+	delta -= Vec2f( math<float>::floor( delta.x + 0.5f ), math<float>::floor( delta.y + 0.5f ) );
+	return a.mPosition.distance( b.mPosition ) <= kTolerance && delta.length() <= kTolerance &&
+		( !normals || a.mNormal.distance( b.mNormal ) <= kTolerance );
+}
+
+// True if \a a and \a b are the same corners in the same winding,
+// starting at any corner
+static bool matches( const Triangle &a, const Triangle &b, bool normals )
+{
+	for ( size_t r = 0; r < 3; ++r ) {
+		if ( matches( a.mCorners[ 0 ], b.mCorners[ r ], normals ) &&
+			matches( a.mCorners[ 1 ], b.mCorners[ ( r + 1 ) % 3 ], normals ) &&
+			matches( a.mCorners[ 2 ], b.mCorners[ ( r + 2 ) % 3 ], normals ) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+* Checks that \a mesh draws the same triangles as \a reference, in any
+* order. Triangles with no area draw nothing, so they are skipped.
+*/
+static void checkSurface( const char *name, const TriMesh &mesh, const TriangleList &reference, bool normals = true )
+{
+	TriangleList expected;
+	for ( TriangleList::const_iterator iter = reference.begin(); iter != reference.end(); ++iter ) {
+		if ( !isDegenerate( *iter ) ) {
+			expected.push_back( *iter );
+		}
+	}
+	TriangleList actual;
+	TriangleList unrolled = unroll( mesh );
+	for ( TriangleList::const_iterator iter = unrolled.begin(); iter != unrolled.end(); ++iter ) {
+		if ( !isDegenerate( *iter ) ) {
+			actual.push_back( *iter );
+		}
+	}
+	check( actual.size() == expected.size(), name, "triangle count differs from the baseline" );
+
+	vector<bool> used( actual.size(), false );
+	size_t numMissing = 0;
+	for ( TriangleList::const_iterator iter = expected.begin(); iter != expected.end(); ++iter ) {
+		size_t i = 0;
+		while ( i < actual.size() && ( used[ i ] || !matches( *iter, actual[ i ], normals ) ) ) {
+			++i;
+		}
+		if ( i < actual.size() ) {
+			used[ i ] = true;
+		} else {
+			++numMissing;
+		}
+	}
+	check( numMissing == 0, name, "baseline triangles missing from the output" );
+}
+
+static void testPrimitives()
+{
+	checkSurface( "square", MeshHelper::createSquare( Vec2i( 3, 2 ) ), baseline::createSquare( Vec2i( 3, 2 ) ) );
+	checkSurface( "cube", MeshHelper::createCube( Vec3i( 2, 3, 4 ) ), baseline::createCube( Vec3i( 2, 3, 4 ) ) );
+	checkSurface( "circle", MeshHelper::createCircle( Vec2i( 12, 3 ) ), baseline::createRing( Vec2i( 12, 3 ), 0.0f ) );
+	checkSurface( "ring", MeshHelper::createRing( Vec2i( 12, 3 ), 0.3f ), baseline::createRing( Vec2i( 12, 3 ), 0.3f ) );
+	for ( int32_t caps = 0; caps < 4; ++caps ) {
+		bool closeTop	= ( caps & 1 ) != 0;
+		bool closeBase	= ( caps & 2 ) != 0;
+		checkSurface( "cylinder", MeshHelper::createCylinder( Vec2i( 12, 4 ), 0.3f, 0.8f, closeTop, closeBase ),
+			baseline::createCylinder( Vec2i( 12, 4 ), 0.3f, 0.8f, closeTop, closeBase ) );
+	}
+	checkSurface( "icosahedron", MeshHelper::createIcosahedron(), baseline::createIcosahedron() );
+	checkSurface( "sphere", MeshHelper::createSphere( Vec2i( 12, 6 ) ), baseline::createSphere( Vec2i( 12, 6 ) ) );
+	checkSurface( "torus", MeshHelper::createTorus( Vec2i( 12, 6 ), 0.4f ), baseline::createTorus( Vec2i( 12, 6 ), 0.4f ), false );
+}
+
+static void testSizes()
+{
+	check( MeshHelper::queryGeosphere( 20724 ).getNumVertices() == 10 * 20724ull * 20724ull + 2, "geosphere",
+		"largest frequency that fits 32-bit indices is rejected" );
+	check( MeshHelper::queryGeosphere( 20725 ).getNumVertices() == 0, "geosphere",
+		"frequency past 32-bit indices is accepted" );
+	check( MeshHelper::queryIcosahedron( 16 ).getNumVertices() == MeshHelper::queryIcosahedron( 15 ).getNumVertices(),
+		"icosahedron", "division is not clamped to 32-bit indices" );
+
+	// Bounds are only written for a mesh that was built
+	MeshBounds bounds;
+	TriMesh mesh;
+	MeshBuilder builder( mesh );
+	check( !MeshHelper::createGeosphere( builder, 20725, &bounds ) && bounds.mRadius == 0.0f, "geosphere",
+		"frequency past 32-bit indices is built" );
+	mesh = MeshHelper::createGeosphere( 20725, MeshHelper::ATTRIB_ALL | MeshHelper::OPTIMIZE_VERTEX_CACHE, &bounds );
+	check( mesh.getNumVertices() == 0 && mesh.getNumIndices() == 0 && bounds.mRadius == 0.0f, "geosphere",
+		"failed build returns a mesh or bounds" );
+	VertexMesh<Vertex> vertexMesh = MeshHelper::createGeosphere<Vertex>( MeshHelper::kMaxGeosphereFrequency + 1, &bounds );
+	check( vertexMesh.getNumVertices() == 0 && bounds.mRadius == 0.0f, "geosphere",
+		"bounds are written for a mesh that was not built" );
+	vertexMesh = MeshHelper::createIcosahedron<Vertex>( 2, &bounds );
+	check( vertexMesh.getNumVertices() == MeshHelper::queryIcosahedron( 2 ).getNumVertices() && bounds.mRadius > 0.0f,
+		"icosahedron", "vertex mesh differs from its query" );
+}
+
+// Every vertex must be inside the box and the sphere reported for it
+static void checkBounds( const char *name, const TriMesh &mesh, const MeshBounds &bounds )
+{
+	bool inside = true;
+	const vector<Vec3f> &positions = mesh.getVertices();
+	for ( vector<Vec3f>::const_iterator iter = positions.begin(); iter != positions.end(); ++iter ) {
+		for ( size_t i = 0; i < 3; ++i ) {
+			inside = inside && ( *iter )[ i ] >= bounds.mMin[ i ] - kTolerance && ( *iter )[ i ] <= bounds.mMax[ i ] + kTolerance;
+		}
+		inside = inside && iter->distance( bounds.mCenter ) <= bounds.mRadius + kTolerance;
+	}
+	check( inside, name, "vertices outside the reported bounds" );
+}
+
+static void testBounds()
+{
+	float ratios[ 4 ] = { 0.0f, 0.5f, 1.5f, -2.0f };
+	for ( size_t i = 0; i < 4; ++i ) {
+		MeshBounds bounds;
+		TriMesh mesh = MeshHelper::createRing( Vec2i( 12, 2 ), ratios[ i ], MeshHelper::ATTRIB_ALL, &bounds );
+		checkBounds( "ring", mesh, bounds );
+	}
+
+	MeshBounds bounds;
+	TriMesh mesh = MeshHelper::createCube( Vec3i( 2, 3, 4 ), MeshHelper::ATTRIB_ALL, &bounds );
+	checkBounds( "cube", mesh, bounds );
+	mesh = MeshHelper::createCylinder( Vec2i( 12, 4 ), 0.3f, 1.5f, true, true, MeshHelper::ATTRIB_ALL, &bounds );
+	checkBounds( "cylinder", mesh, bounds );
+	mesh = MeshHelper::createSphere( Vec2i( 12, 6 ), MeshHelper::ATTRIB_ALL, &bounds );
+	checkBounds( "sphere", mesh, bounds );
+	mesh = MeshHelper::createTorus( Vec2i( 12, 6 ), 0.4f, MeshHelper::ATTRIB_ALL, &bounds );
+	checkBounds( "torus", mesh, bounds );
+}
+
+// Torus with a tube radius of 0.25 around a ring of 0.5
+static SurfacePoint torusSurface( float u, float v )
+{
+	float theta			= u * 2.0f * (float)M_PI;
+	float phi			= v * 2.0f * (float)M_PI;
+	Vec3f tube( math<float>::cos( theta ) * math<float>::cos( phi ), math<float>::sin( phi ),
+		math<float>::sin( theta ) * math<float>::cos( phi ) );
+	Vec3f ring( math<float>::cos( theta ), 0.0f, math<float>::sin( theta ) );
+	return SurfacePoint( ring * 0.5f + tube * 0.25f, tube );
+}
+
+// Returns the most quads of \a resolution any triangle spans in texture space
+static float measureSpan( const TriMesh &mesh, const Vec2i &resolution )
+{
+	float span = 0.0f;
+	TriangleList triangles = unroll( mesh );
+	for ( TriangleList::const_iterator iter = triangles.begin(); iter != triangles.end(); ++iter ) {
+		for ( size_t i = 0; i < 3; ++i ) {
+			Vec2f delta = iter->mCorners[ i ].mTexCoord - iter->mCorners[ ( i + 1 ) % 3 ].mTexCoord;
+			span = math<float>::max( span, math<float>::max( math<float>::abs( delta.x ) * resolution.x,
+				math<float>::abs( delta.y ) * resolution.y ) );
+		}
+	}
+	return span;
+}
+
+/*
+* Checks that the lattice of \a resolution quads at the start of \a mesh
+* closes each direction in \a wrap with a line repeating the first one's
+* positions and normals. If \a texCoords, the closing line's texture
+* coordinate must be 1.
+*/
+static void checkSeams( const char *name, const TriMesh &mesh, const Vec2i &resolution, uint32_t wrap, bool texCoords )
+{
+	const vector<Vec3f> &positions	= mesh.getVertices();
+	const vector<Vec3f> &normals	= mesh.getNormals();
+	const vector<Vec2f> &uvs		= mesh.getTexCoords();
+	size_t stride					= (size_t)resolution.x + 1;
+	bool closed						= true;
+	for ( int32_t p = 0; ( wrap & MeshHelper::PARAMETRIC_WRAP_U ) != 0 && p <= resolution.y; ++p ) {
+		size_t first	= p * stride;
+		size_t last		= first + resolution.x;
+		closed = closed && positions[ first ] == positions[ last ] && normals[ first ] == normals[ last ] &&
+			( !texCoords || uvs[ last ].x == 1.0f );
+	}
+	for ( int32_t t = 0; ( wrap & MeshHelper::PARAMETRIC_WRAP_V ) != 0 && t <= resolution.x; ++t ) {
+		size_t last = resolution.y * stride + t;
+		closed = closed && positions[ t ] == positions[ last ] && normals[ t ] == normals[ last ] &&
+			( !texCoords || uvs[ last ].y == 1.0f );
+	}
+	check( closed, name, "seam lines do not match" );
+}
+
+static void testParametric()
+{
+	uint32_t wrap	= MeshHelper::PARAMETRIC_WRAP_U | MeshHelper::PARAMETRIC_WRAP_V;
+	Vec2i resolution( 8, 4 );
+	TriMesh mesh	= MeshHelper::createParametric( resolution, &torusSurface, wrap );
+	MeshSize size	= MeshHelper::queryParametric( resolution, wrap );
+	check( mesh.getNumVertices() == 9 * 5 && size.getNumVertices() == mesh.getNumVertices() &&
+		size.getNumIndices() == mesh.getIndices().size(), "parametric", "wrapped seams are not duplicated" );
+
+	// No triangle may span more than one quad of texture space
+	check( measureSpan( mesh, resolution ) <= 1.0f + kTolerance, "parametric", "triangles span the texture seam" );
+	checkSeams( "parametric", mesh, resolution, wrap, true );
+
+	wrap	|= MeshHelper::PARAMETRIC_SHARE_SEAMS;
+	mesh	= MeshHelper::createParametric( resolution, &torusSurface, wrap );
+	check( mesh.getNumVertices() == 8 * 4 && MeshHelper::queryParametric( resolution, wrap ).getNumVertices() == 8 * 4,
+		"parametric", "shared seams are duplicated" );
+
+	// The built-ins close their seams the same way. The torus's lattice 
+	// runs around the tube first, and the sphere's texture coordinates 
+	// are projected, so only its positions and normals are compared.
+	resolution	= Vec2i( 12, 6 );
+	mesh		= MeshHelper::createCylinder( resolution, 0.3f, 0.8f );
+	size		= MeshHelper::queryCylinder( resolution );
+	check( size.getNumVertices() == mesh.getNumVertices() && size.getNumIndices() == mesh.getIndices().size() &&
+		mesh.getNumVertices() == 13 * 7 + 13 * 2, "cylinder", "query does not match the mesh" );
+	check( measureSpan( mesh, resolution ) <= 1.0f + kTolerance, "cylinder", "triangles span the texture seam" );
+	checkSeams( "cylinder", mesh, resolution, MeshHelper::PARAMETRIC_WRAP_U, true );
+
+	mesh = MeshHelper::createSphere( resolution );
+	size = MeshHelper::querySphere( resolution );
+	check( size.getNumVertices() == mesh.getNumVertices() && size.getNumIndices() == mesh.getIndices().size() &&
+		mesh.getNumVertices() == 13 * 7, "sphere", "query does not match the mesh" );
+	checkSeams( "sphere", mesh, resolution, MeshHelper::PARAMETRIC_WRAP_U, false );
+
+	Vec2i lattice( resolution.y, resolution.x );
+	mesh = MeshHelper::createTorus( resolution, 0.4f );
+	size = MeshHelper::queryTorus( resolution );
+	check( size.getNumVertices() == mesh.getNumVertices() && size.getNumIndices() == mesh.getIndices().size() &&
+		mesh.getNumVertices() == 7 * 13, "torus", "query does not match the mesh" );
+	check( measureSpan( mesh, lattice ) <= 1.0f + kTolerance, "torus", "triangles span the texture seam" );
+	checkSeams( "torus", mesh, lattice, MeshHelper::PARAMETRIC_WRAP_U | MeshHelper::PARAMETRIC_WRAP_V, true );
+}
+
+// Threads split the work, not the result, so every thread count must 
+// produce the same mesh
+static void testSubdivide()
+{
+	TriMesh source		= MeshHelper::createIcosahedron( 1 );
+	TriMesh reference	= MeshHelper::subdivide( source, 8, true, 1 );
+	check( reference.getNumIndices() / 3 > 65536, "subdivide", "mesh is too small to be split across threads" );
+
+	uint32_t numThreads[ 3 ] = { 2, 3, 16 };
+	for ( size_t i = 0; i < 3; ++i ) {
+		TriMesh mesh = MeshHelper::subdivide( source, 8, true, numThreads[ i ] );
+		check( mesh.getIndices() == reference.getIndices(), "subdivide", "indices depend on the thread count" );
+		check( mesh.getVertices() == reference.getVertices() && mesh.getNormals() == reference.getNormals() &&
+			mesh.getTexCoords() == reference.getTexCoords(), "subdivide", "vertices depend on the thread count" );
+	}
+}
+
+// True if any vertex of \a mesh is exactly at \a position
+static bool hasPosition( const TriMesh &mesh, const Vec3f &position )
+{
+	return find( mesh.getVertices().begin(), mesh.getVertices().end(), position ) != mesh.getVertices().end();
+}
+
+static void testSimplify()
+{
+	// A closed sphere can reach the target, within the error allowed, 
+	// and every triangle keeps facing outward
+	float maxError		= 0.05f;
+	float resultError	= -1.0f;
+	TriMesh sphere		= MeshHelper::createGeosphere( 8 );
+	TriMesh mesh		= MeshHelper::simplify( sphere, 320, maxError, 0.5f, 1.0f, &resultError );
+	size_t numTriangles	= mesh.getNumIndices() / 3;
+	check( numTriangles > 0 && numTriangles <= 320, "simplify", "sphere does not reach the target" );
+	check( resultError > 0.0f && resultError <= maxError, "simplify", "error is outside the allowed range" );
+	bool outward = true;
+	TriangleList triangles = unroll( mesh );
+	for ( TriangleList::const_iterator iter = triangles.begin(); iter != triangles.end(); ++iter ) {
+		const Vec3f &a = iter->mCorners[ 0 ].mPosition;
+		Vec3f normal = ( iter->mCorners[ 1 ].mPosition - a ).cross( iter->mCorners[ 2 ].mPosition - a );
+		outward = outward && normal.dot( a + iter->mCorners[ 1 ].mPosition + iter->mCorners[ 2 ].mPosition ) > 0.0f;
+	}
+	check( outward, "simplify", "triangles flip" );
+
+	// Open edges stay in place
+	Vec2i resolution( 8, 8 );
+	TriMesh square = MeshHelper::createSquare( resolution );
+	mesh = MeshHelper::simplify( square, 8, 1.0f );
+	bool outline = mesh.getNumIndices() < square.getNumIndices();
+	for ( int32_t y = 0; y <= resolution.y; ++y ) {
+		for ( int32_t x = 0; x <= resolution.x; ++x ) {
+			if ( x == 0 || y == 0 || x == resolution.x || y == resolution.y ) {
+				outline = outline && hasPosition( mesh, square.getVertices()[ y * ( resolution.x + 1 ) + x ] );
+			}
+		}
+	}
+	check( outline, "simplify", "open edges move" );
+
+	// So do the texture seam and poles of a lattice sphere
+	resolution	= Vec2i( 24, 12 );
+	sphere		= MeshHelper::createSphere( resolution );
+	mesh		= MeshHelper::simplify( sphere, 100, 1.0f );
+	bool seams	= mesh.getNumIndices() < sphere.getNumIndices();
+	for ( int32_t p = 0; p <= resolution.y; ++p ) {
+		seams = seams && hasPosition( mesh, sphere.getVertices()[ p * ( resolution.x + 1 ) ] );
+	}
+	for ( int32_t t = 0; t <= resolution.x; ++t ) {
+		seams = seams && hasPosition( mesh, sphere.getVertices()[ t ] ) &&
+			hasPosition( mesh, sphere.getVertices()[ resolution.y * ( resolution.x + 1 ) + t ] );
+	}
+	check( seams, "simplify", "seam vertices move" );
+
+	bool thrown = false;
+	try {
+		mesh = sphere;
+		mesh.getIndices()[ 4 ] = (uint32_t)mesh.getNumVertices();
+		MeshHelper::simplify( mesh, 100 );
+	} catch ( const out_of_range & ) {
+		thrown = true;
+	}
+	check( thrown, "simplify", "index out of range is accepted" );
+}
+
+// Returns the triangles of \a indices, each rotated to start at its 
+// smallest index, which keeps its winding, in sorted order
+static vector<uint64_t> sortTriangles( const vector<uint32_t> &indices )
+{
+	vector<uint64_t> triangles;
+	for ( size_t i = 0; i + 2 < indices.size(); i += 3 ) {
+		size_t r = indices[ i ] < indices[ i + 1 ] ? i : i + 1;
+		r = indices[ r ] < indices[ i + 2 ] ? r : i + 2;
+		uint64_t a = indices[ r ];
+		uint64_t b = indices[ i + ( r - i + 1 ) % 3 ];
+		uint64_t c = indices[ i + ( r - i + 2 ) % 3 ];
+		triangles.push_back( ( a << 42 ) | ( b << 21 ) | c );
+	}
+	sort( triangles.begin(), triangles.end() );
+	return triangles;
+}
+
+static void testVertexCache()
+{
+	TriMesh sphere	= MeshHelper::createSphere( Vec2i( 48, 24 ) );
+	TriMesh mesh	= sphere;
+	MeshHelper::optimizeVertexCache( mesh );
+	check( MeshHelper::calcAcmr( mesh ) < MeshHelper::calcAcmr( sphere ), "optimizeVertexCache", "ACMR does not drop" );
+	check( sortTriangles( mesh.getIndices() ) == sortTriangles( sphere.getIndices() ), "optimizeVertexCache",
+		"triangles or their winding change" );
+	check( mesh.getVertices() == sphere.getVertices(), "optimizeVertexCache", "vertices change" );
+}
+
+static void testOverdraw()
+{
+	// A torus hides part of itself from most directions
+	TriMesh mesh = MeshHelper::createTorus( Vec2i( 48, 24 ), 0.5f );
+	MeshHelper::optimizeVertexCache( mesh );
+	vector<uint64_t> triangles	= sortTriangles( mesh.getIndices() );
+	float acmr					= MeshHelper::calcAcmr( mesh );
+	float overdraw				= MeshHelper::calcOverdraw( mesh );
+
+	float threshold = 1.05f;
+	MeshHelper::optimizeOverdraw( mesh, threshold );
+	check( MeshHelper::calcOverdraw( mesh ) < overdraw, "optimizeOverdraw", "overdraw does not drop" );
+	check( MeshHelper::calcAcmr( mesh ) <= acmr * threshold, "optimizeOverdraw", "ACMR exceeds the threshold" );
+	check( sortTriangles( mesh.getIndices() ) == triangles, "optimizeOverdraw", "triangles or their winding change" );
+}
+
+// True if each index is either one already seen or the next unused one
+static bool isFirstUseOrder( const vector<uint32_t> &indices )
+{
+	uint32_t next = 0;
+	for ( size_t i = 0; i < indices.size(); ++i ) {
+		if ( indices[ i ] > next ) {
+			return false;
+		}
+		next = indices[ i ] == next ? next + 1 : next;
+	}
+	return true;
+}
+
+// True if every corner of \a mesh has the same attributes as in 
+// \a reference, including the per-vertex \a extra arrays
+template<typename T>
+static bool isSameCorners( const TriMesh &mesh, const vector<T> &extra, const TriMesh &reference, 
+	const vector<T> &referenceExtra )
+{
+	const vector<uint32_t> &a = mesh.getIndices();
+	const vector<uint32_t> &b = reference.getIndices();
+	bool same = a.size() == b.size() && mesh.getNumVertices() == reference.getNumVertices();
+	for ( size_t i = 0; same && i < a.size(); ++i ) {
+		same = mesh.getVertices()[ a[ i ] ] == reference.getVertices()[ b[ i ] ] &&
+			mesh.getNormals()[ a[ i ] ] == reference.getNormals()[ b[ i ] ] &&
+			mesh.getTexCoords()[ a[ i ] ] == reference.getTexCoords()[ b[ i ] ] &&
+			extra[ a[ i ] ] == referenceExtra[ b[ i ] ];
+	}
+	return same;
+}
+
+static void testVertexFetch()
+{
+	uint32_t flags = MeshHelper::ATTRIB_ALL | MeshHelper::OPTIMIZE_VERTEX_CACHE;
+	vector<Vec4f> referenceTangents;
+	vector<Vec4f> tangents;
+	TriMesh reference	= MeshHelper::createSphere( Vec2i( 24, 12 ), referenceTangents, flags );
+	TriMesh mesh		= MeshHelper::createSphere( Vec2i( 24, 12 ), tangents, flags | MeshHelper::OPTIMIZE_VERTEX_FETCH );
+	check( isFirstUseOrder( mesh.getIndices() ), "optimizeVertexFetch", "vertices are not in first-use order" );
+	check( isSameCorners( mesh, tangents, reference, referenceTangents ), "optimizeVertexFetch",
+		"attributes or tangents are remapped differently" );
+
+	vector<Vec3f> referenceParents;
+	vector<Vec3f> parents;
+	reference	= MeshHelper::subdivide( MeshHelper::createIcosahedron( 1 ), referenceParents, 3, true, 0, flags );
+	mesh		= MeshHelper::subdivide( MeshHelper::createIcosahedron( 1 ), parents, 3, true, 0,
+		flags | MeshHelper::OPTIMIZE_VERTEX_FETCH );
+	check( isFirstUseOrder( mesh.getIndices() ), "optimizeVertexFetch", "vertices are not in first-use order" );
+	check( isSameCorners( mesh, parents, reference, referenceParents ), "optimizeVertexFetch",
+		"attributes or parent positions are remapped differently" );
+}
+
+// Converts \a strips back to a triangle list, undoing the reversed 
+// winding of every odd triangle in a strip
+static vector<uint32_t> unstrip( const vector<uint32_t> &strips, uint32_t restart )
+{
+	vector<uint32_t> indices;
+	for ( size_t start = 0; start < strips.size(); ) {
+		size_t end = find( strips.begin() + start, strips.end(), restart ) - strips.begin();
+		for ( size_t k = start; k + 2 < end; ++k ) {
+			bool even = ( k - start ) % 2 == 0;
+			indices.push_back( strips[ even ? k : k + 1 ] );
+			indices.push_back( strips[ even ? k + 1 : k ] );
+			indices.push_back( strips[ k + 2 ] );
+		}
+		start = end + 1;
+	}
+	return indices;
+}
+
+static void testStripify()
+{
+	TriMesh mesh				= MeshHelper::createSphere( Vec2i( 24, 12 ) );
+	vector<uint32_t> strips		= MeshHelper::stripify( mesh.getIndices() );
+	check( strips.size() < mesh.getNumIndices() && sortTriangles( unstrip( strips, 0xFFFFFFFF ) ) ==
+		sortTriangles( mesh.getIndices() ), "stripify", "strips do not draw the input triangles" );
+
+	vector<uint16_t> indices16( mesh.getIndices().begin(), mesh.getIndices().end() );
+	vector<uint16_t> strips16 = MeshHelper::stripify( indices16 );
+	check( sortTriangles( unstrip( vector<uint32_t>( strips16.begin(), strips16.end() ), 0xFFFF ) ) ==
+		sortTriangles( mesh.getIndices() ), "stripify", "16-bit strips do not draw the input triangles" );
+
+	size_t numThrown = 0;
+	try {
+		vector<uint32_t> indices = mesh.getIndices();
+		indices[ 4 ] = 0xFFFFFFFF;
+		MeshHelper::stripify( indices );
+	} catch ( const out_of_range & ) {
+		++numThrown;
+	}
+	try {
+		indices16[ 4 ] = 0xFFFF;
+		MeshHelper::stripify( indices16 );
+	} catch ( const out_of_range & ) {
+		++numThrown;
+	}
+	check( numThrown == 2, "stripify", "restart index is accepted as a vertex" );
+}
+
+static void testMeshlets()
+{
+	TriMesh mesh = MeshHelper::createGeosphere( 8 );
+	const vector<Vec3f> &positions = mesh.getVertices();
+	uint32_t limits[ 2 ][ 2 ] = { { 64, 126 }, { 32, 40 } };
+	for ( size_t i = 0; i < 2; ++i ) {
+		MeshletMesh meshlets = MeshHelper::buildMeshlets( mesh, limits[ i ][ 0 ], limits[ i ][ 1 ] );
+		vector<uint32_t> indices;
+		bool withinLimits	= true;
+		bool bounded		= true;
+		size_t numCones		= 0;
+		for ( vector<Meshlet>::const_iterator iter = meshlets.getMeshlets().begin(); iter != meshlets.getMeshlets().end(); ++iter ) {
+			withinLimits = withinLimits && iter->mNumVertices <= limits[ i ][ 0 ] && iter->mNumTriangles <= limits[ i ][ 1 ];
+			const uint32_t *vertices	= &meshlets.getVertices()[ iter->mVertexOffset ];
+			const uint8_t *triangles	= &meshlets.getTriangles()[ iter->mTriangleOffset * 3 ];
+			for ( uint32_t v = 0; v < iter->mNumVertices; ++v ) {
+				bounded = bounded && positions[ vertices[ v ] ].distance( iter->mCenter ) <= iter->mRadius + kTolerance;
+			}
+
+			// Every triangle normal must lie inside the cone
+			float minDot = math<float>::sqrt( 1.0f - iter->mConeCutoff * iter->mConeCutoff );
+			numCones += iter->mConeCutoff < 1.0f ? 1 : 0;
+			for ( uint32_t t = 0; t < iter->mNumTriangles; ++t ) {
+				const Vec3f &a	= positions[ vertices[ triangles[ t * 3 + 0 ] ] ];
+				const Vec3f &b	= positions[ vertices[ triangles[ t * 3 + 1 ] ] ];
+				const Vec3f &c	= positions[ vertices[ triangles[ t * 3 + 2 ] ] ];
+				Vec3f normal	= ( b - a ).cross( c - a ).normalized();
+				bounded = bounded && ( iter->mConeCutoff >= 1.0f || normal.dot( iter->mConeAxis ) >= minDot - kTolerance );
+				for ( size_t k = 0; k < 3; ++k ) {
+					indices.push_back( vertices[ triangles[ t * 3 + k ] ] );
+				}
+			}
+		}
+		check( withinLimits, "buildMeshlets", "meshlets exceed their vertex or triangle limit" );
+		check( sortTriangles( indices ) == sortTriangles( mesh.getIndices() ), "buildMeshlets",
+			"triangles are not each emitted exactly once" );
+		check( bounded && numCones > 0, "buildMeshlets", "bounding sphere or cone misses its meshlet" );
+	}
+}
+
+static void testSplit()
+{
+	// Ranges index their own block of vertices and draw the source 
+	// triangles in order
+	TriMesh source	= MeshHelper::createSphere( Vec2i( 48, 24 ) );
+	TriMesh16 mesh	= MeshHelper::split( source, 200 );
+	const vector<DrawRange> &ranges = mesh.getDrawRanges();
+	bool withinLimits	= ranges.size() > 1;
+	bool same			= true;
+	size_t i			= 0;
+	for ( vector<DrawRange>::const_iterator iter = ranges.begin(); iter != ranges.end(); ++iter ) {
+		withinLimits = withinLimits && iter->mNumVertices <= 200 && iter->mFirstIndex == i &&
+			iter->mBaseVertex + iter->mNumVertices <= mesh.getNumVertices();
+		for ( uint32_t j = 0; j < iter->mNumIndices; ++j, ++i ) {
+			uint32_t index	= mesh.getIndices()[ iter->mFirstIndex + j ];
+			uint32_t vertex	= iter->mBaseVertex + index;
+			uint32_t from	= source.getIndices()[ i ];
+			withinLimits	= withinLimits && index < iter->mNumVertices;
+			same = same && vertex < mesh.getNumVertices() && mesh.getVertices()[ vertex ] == source.getVertices()[ from ] &&
+				mesh.getNormals()[ vertex ] == source.getNormals()[ from ] &&
+				mesh.getTexCoords()[ vertex ] == source.getTexCoords()[ from ];
+		}
+	}
+	check( withinLimits, "split", "ranges exceed their vertex limit or index outside it" );
+	check( same && i == source.getNumIndices(), "split", "ranges do not draw the source triangles" );
+
+	// Building straight into a TriMesh16 only allocates the attributes asked for
+	MeshBuilder builder( mesh, 0 );
+	check( MeshHelper::createSphere( builder, Vec2i( 12, 6 ) ) && mesh.getNormals().empty() &&
+		mesh.getTexCoords().empty() && mesh.getNumVertices() == MeshHelper::querySphere( Vec2i( 12, 6 ) ).getNumVertices() &&
+		mesh.getDrawRanges().size() == 1, "MeshBuilder", "TriMesh16 builder writes attributes left out" );
+}
+
+static void testQuantization()
+{
+	// Each encoding's worst case is half a step: 2^-11 relative for half 
+	// floats and 1 / 65534 for snorm16 positions inside [-1, 1], under 
+	// 0.01 degrees for oct16 normals and 1 / 131070 for unorm16 texture 
+	// coordinates, widened for the number of components. Float normals 
+	// only lose the rounding of renormalizing them.
+	TriMesh reference = MeshHelper::createSphere( Vec2i( 24, 12 ) );
+	size_t numVertices = reference.getNumVertices();
+	struct Encoding
+	{
+		VertexFormat	mFormat;
+		size_t			mStride;
+		float			mMaxPosition;
+		float			mMaxNormalAngle;
+		float			mMaxTexCoord;
+	};
+	Encoding encodings[ 3 ] = {
+		{ VertexFormat(), 32, 0.0f, 0.0001f, 0.0f }, 
+		{ VertexFormat( VertexFormat::POSITION_HALF, VertexFormat::NORMAL_OCT16, VertexFormat::TEX_COORD_UNORM16 ), 
+			16, 1.0f / 2048.0f * 1.733f, 0.01f, 1.0f / 131070.0f * 1.415f }, 
+		{ VertexFormat( VertexFormat::POSITION_SNORM16, VertexFormat::NORMAL_OCT16, VertexFormat::TEX_COORD_UNORM16 ), 
+			16, 1.0f / 65534.0f * 1.733f, 0.01f, 1.0f / 131070.0f * 1.415f }
+	};
+	for ( size_t i = 0; i < 3; ++i ) {
+		const Encoding &encoding	= encodings[ i ];
+		InterleavedMesh mesh		= MeshHelper::interleave( reference, encoding.mFormat );
+		QuantizationError error		= MeshHelper::measureQuantizationError( mesh, reference );
+		check( encoding.mFormat.getStride() == encoding.mStride && error.mNumBytes == numVertices * encoding.mStride &&
+			error.mNumReferenceBytes == numVertices * 32, "measureQuantizationError", "sizes are wrong" );
+		check( error.mMaxPosition <= encoding.mMaxPosition && error.mMeanPosition <= error.mMaxPosition,
+			"measureQuantizationError", "position error is past its encoding's bound" );
+		check( error.mMaxNormalAngle <= encoding.mMaxNormalAngle && error.mMeanNormalAngle <= error.mMaxNormalAngle,
+			"measureQuantizationError", "normal error is past its encoding's bound" );
+		check( error.mMaxTexCoord <= encoding.mMaxTexCoord, "measureQuantizationError",
+			"texture coordinate error is past its encoding's bound" );
+	}
+}
+
+/*
+* Checks that \a chain has \a numLevels levels drawing consecutive ranges of 
+* its shared index buffer, each coarser than the last, and that selectLevel() 
+* picks the coarsest level within the pixel error at each distance.
+*/
+static void checkLodChain( const char *name, const LodChain &chain, size_t numLevels )
+{
+	const vector<LodLevel> &levels	= chain.getLevels();
+	const TriMesh &mesh				= chain.getMesh();
+	check( levels.size() == numLevels, name, "level count is wrong" );
+
+	bool ranges		= true;
+	bool monotone	= true;
+	uint32_t next	= 0;
+	for ( size_t i = 0; i < levels.size(); ++i ) {
+		const DrawRange &range = levels[ i ].mRange;
+		ranges = ranges && range.mBaseVertex == 0 && range.mFirstIndex == next && range.mNumIndices > 0 &&
+			range.mNumIndices % 3 == 0 && range.mNumVertices == mesh.getNumVertices();
+		for ( uint32_t j = range.mFirstIndex; ranges && j < range.mFirstIndex + range.mNumIndices; ++j ) {
+			ranges = mesh.getIndices()[ j ] < mesh.getNumVertices();
+		}
+		next += range.mNumIndices;
+		if ( i > 0 ) {
+			monotone = monotone && levels[ i ].mError > levels[ i - 1 ].mError &&
+				range.mNumIndices < levels[ i - 1 ].mRange.mNumIndices;
+		}
+	}
+	check( ranges && next == mesh.getNumIndices(), name, "draw ranges do not tile the shared index buffer" );
+	check( monotone, name, "coarser levels do not have fewer triangles and more error" );
+
+	float scale		= 1000.0f;
+	bool selected	= chain.selectLevel( 0.0f, scale ) == 0;
+	size_t previous	= 0;
+	for ( float distance = 0.5f; distance < 1000.0f; distance *= 1.1f ) {
+		size_t level		= chain.selectLevel( distance, scale );
+		bool withinError	= level == 0 || levels[ level ].mError * scale / distance <= 1.0f;
+		bool coarsest		= level + 1 == levels.size() || levels[ level + 1 ].mError * scale / distance > 1.0f;
+		selected			= selected && withinError && coarsest && level >= previous;
+		previous			= level;
+	}
+	check( selected && previous + 1 == levels.size(), name, "selectLevel does not pick the coarsest level in range" );
+}
+
+static void testLodChains()
+{
+	checkLodChain( "cylinder LOD", MeshHelper::createCylinderLodChain( Vec2i( 48, 8 ), 0.5f, 0.3f ), 4 );
+	checkLodChain( "geosphere LOD", MeshHelper::createGeosphereLodChain( 16 ), 4 );
+	checkLodChain( "geosphere LOD", MeshHelper::createGeosphereLodChain( 6 ), 2 );
+	checkLodChain( "sphere LOD", MeshHelper::createSphereLodChain( Vec2i( 48, 24 ) ), 4 );
+	checkLodChain( "sphere LOD", MeshHelper::createSphereLodChain( Vec2i( 12, 6 ) ), 2 );
+	checkLodChain( "torus LOD", MeshHelper::createTorusLodChain( Vec2i( 48, 24 ), 0.5f, 3, 
+		MeshHelper::ATTRIB_ALL | MeshHelper::OPTIMIZE_VERTEX_CACHE ), 3 );
+}
+
+/*
+* Checks that every vertex \a chain drops after level L has its parent at the 
+* midpoint of an edge of level L + 1, that the coarsest level's vertices are 
+* their own parents, and that each level has fully morphed where 
+* selectLevel() swaps in the next.
+*/
+static void checkGeomorph( const char *name, const LodChain &chain )
+{
+	const vector<LodLevel> &levels		= chain.getLevels();
+	const vector<uint32_t> &indices		= chain.getMesh().getIndices();
+	const vector<Vec3f> &positions		= chain.getMesh().getVertices();
+	const vector<Vec3f> &parents		= chain.getParentPositions();
+	const vector<uint8_t> &vertexLevels	= chain.getVertexLevels();
+	check( parents.size() == positions.size() && vertexLevels.size() == positions.size(), name,
+		"geomorph data is missing" );
+	if ( parents.size() != positions.size() || vertexLevels.size() != positions.size() ) {
+		return;
+	}
+
+	bool onEdge = true;
+	size_t numMorphed = 0;
+	for ( size_t v = 0; v < positions.size(); ++v ) {
+		size_t level = vertexLevels[ v ];
+		if ( level + 1 >= levels.size() ) {
+			onEdge = onEdge && parents[ v ] == positions[ v ];
+			continue;
+		}
+		const DrawRange &coarse = levels[ level + 1 ].mRange;
+		bool found = false;
+		for ( uint32_t i = coarse.mFirstIndex; !found && i < coarse.mFirstIndex + coarse.mNumIndices; ++i ) {
+			const Vec3f &a	= positions[ indices[ i ] ];
+			const Vec3f &b	= positions[ indices[ i - i % 3 + ( i + 1 ) % 3 ] ];
+			found			= parents[ v ].distance( a.lerp( 0.5f, b ) ) <= kTolerance;
+		}
+		onEdge = onEdge && found;
+		++numMorphed;
+	}
+	check( onEdge && numMorphed > 0, name, "parents do not lie on the coarser level's edges" );
+
+	// Level L + 1 is swapped in at the distance where its error is one pixel
+	float scale		= 1000.0f;
+	bool morphed	= true;
+	for ( size_t level = 0; level + 1 < levels.size(); ++level ) {
+		float distance = levels[ level + 1 ].mError * scale;
+		morphed = morphed && chain.selectLevel( distance * 0.999f, scale ) == level &&
+			chain.selectLevel( distance, scale ) == level + 1 &&
+			chain.getMorphFactor( level, distance * 0.999f, scale ) > 0.99f &&
+			chain.getMorphFactor( level, distance, scale ) == 1.0f &&
+			chain.getMorphFactor( level, distance * 0.5f, scale ) == 0.0f;
+	}
+	check( morphed, name, "morph factor does not reach 1 where the level switches" );
+}
+
+static void testGeomorph()
+{
+	uint32_t flags = MeshHelper::ATTRIB_ALL | MeshHelper::ATTRIB_PARENT_POSITION;
+	checkGeomorph( "cylinder geomorph", MeshHelper::createCylinderLodChain( Vec2i( 48, 8 ), 0.5f, 0.3f, true, true, 4, flags ) );
+	checkGeomorph( "geosphere geomorph", MeshHelper::createGeosphereLodChain( 16, 4, flags ) );
+	checkGeomorph( "sphere geomorph", MeshHelper::createSphereLodChain( Vec2i( 48, 24 ), 4, flags ) );
+	checkGeomorph( "torus geomorph", MeshHelper::createTorusLodChain( Vec2i( 48, 24 ), 0.5f, 4, flags ) );
+}
+
+// Textured square grid of \a resolution quads displaced into a bumpy surface
+static TriMesh createBumpyGrid( const Vec2i &resolution )
+{
+	TriMesh mesh = MeshHelper::createSquare( resolution, MeshHelper::ATTRIB_TEX_COORD );
+	vector<Vec3f> &positions = mesh.getVertices();
+	for ( vector<Vec3f>::iterator iter = positions.begin(); iter != positions.end(); ++iter ) {
+		iter->z = math<float>::sin( iter->x * 11.0f ) * math<float>::cos( iter->y * 7.0f ) * 0.2f;
+	}
+	return mesh;
+}
+
+// Straightforward smooth normals, one triangle corner at a time
+static vector<Vec3f> computeReferenceNormals( const TriMesh &mesh, MeshHelper::NormalWeight weight )
+{
+	const vector<uint32_t> &indices	= mesh.getIndices();
+	const vector<Vec3f> &positions	= mesh.getVertices();
+	vector<Vec3f> normals( positions.size(), Vec3f::zero() );
+	for ( size_t i = 0; i + 2 < indices.size(); i += 3 ) {
+		for ( size_t k = 0; k < 3; ++k ) {
+			const Vec3f &a	= positions[ indices[ i + k ] ];
+			const Vec3f &b	= positions[ indices[ i + ( k + 1 ) % 3 ] ];
+			const Vec3f &c	= positions[ indices[ i + ( k + 2 ) % 3 ] ];
+			Vec3f normal	= ( b - a ).cross( c - a );
+			if ( weight == MeshHelper::NORMAL_WEIGHT_ANGLE ) {
+				float angle	= math<float>::acos( math<float>::clamp( ( b - a ).normalized().dot( ( c - a ).normalized() ), -1.0f, 1.0f ) );
+				normal		= normal.normalized() * angle;
+			}
+			normals[ indices[ i + k ] ] += normal;
+		}
+	}
+	for ( size_t i = 0; i < normals.size(); ++i ) {
+		normals[ i ].normalize();
+	}
+	return normals;
+}
+
+static void testNormals()
+{
+	MeshHelper::NormalWeight weights[ 2 ] = { MeshHelper::NORMAL_WEIGHT_AREA, MeshHelper::NORMAL_WEIGHT_ANGLE };
+	for ( size_t w = 0; w < 2; ++w ) {
+		TriMesh mesh = createBumpyGrid( Vec2i( 24, 16 ) );
+		MeshHelper::computeNormals( mesh, weights[ w ] );
+		vector<Vec3f> reference = computeReferenceNormals( mesh, weights[ w ] );
+		float error = 0.0f;
+		for ( size_t i = 0; i < reference.size(); ++i ) {
+			error = math<float>::max( error, mesh.getNormals()[ i ].distance( reference[ i ] ) );
+		}
+		check( mesh.getNormals().size() == reference.size() && error <= 1e-4f, "computeNormals",
+			"normals differ from the scalar reference" );
+
+		// Above the threading threshold every thread count sums in the same order
+		mesh = createBumpyGrid( Vec2i( 200, 200 ) );
+		MeshHelper::computeNormals( mesh, weights[ w ], 1 );
+		vector<Vec3f> normals = mesh.getNormals();
+		uint32_t numThreads[ 3 ] = { 2, 3, 16 };
+		bool same = mesh.getNumIndices() / 3 > 65536;
+		for ( size_t i = 0; i < 3; ++i ) {
+			MeshHelper::computeNormals( mesh, weights[ w ], numThreads[ i ] );
+			same = same && mesh.getNormals() == normals;
+		}
+		check( same, "computeNormals", "normals depend on the thread count" );
+	}
+}
+
+/*! Checks that each tangent of \a mesh is unit length and orthogonal to its 
+	normal, and that w is the side of the texture's t axis wherever the 
+	triangles around the vertex agree on it. */
+static void checkTangents( const char *name, const TriMesh &mesh, const vector<Vec4f> &tangents )
+{
+	const vector<uint32_t> &indices	= mesh.getIndices();
+	const vector<Vec3f> &positions	= mesh.getVertices();
+	const vector<Vec3f> &normals	= mesh.getNormals();
+	const vector<Vec2f> &texCoords	= mesh.getTexCoords();
+	bool orthonormal = tangents.size() == positions.size();
+	for ( size_t i = 0; orthonormal && i < tangents.size(); ++i ) {
+		Vec3f t		= tangents[ i ].xyz();
+		orthonormal	= math<float>::abs( t.length() - 1.0f ) <= 1e-4f && math<float>::abs( t.dot( normals[ i ] ) ) <= 1e-4f && 
+			math<float>::abs( tangents[ i ].w ) == 1.0f;
+	}
+	check( orthonormal, name, "tangents are not unit length and orthogonal to the normals" );
+	if ( !orthonormal ) {
+		return;
+	}
+
+	// A triangle's t axis is on the side of normal x tangent its texture 
+	// winding says, relative to the normal
+	vector<int32_t> sides( positions.size(), 0 );
+	vector<bool> mixed( positions.size(), false );
+	for ( size_t i = 0; i + 2 < indices.size(); i += 3 ) {
+		const uint32_t *t	= &indices[ i ];
+		Vec3f face			= ( positions[ t[ 1 ] ] - positions[ t[ 0 ] ] ).cross( positions[ t[ 2 ] ] - positions[ t[ 0 ] ] );
+		Vec2f d1			= texCoords[ t[ 1 ] ] - texCoords[ t[ 0 ] ];
+		Vec2f d2			= texCoords[ t[ 2 ] ] - texCoords[ t[ 0 ] ];
+		float area			= d1.x * d2.y - d2.x * d1.y;
+		if ( math<float>::abs( area ) < 1e-9f ) {
+			continue;
+		}
+		for ( size_t k = 0; k < 3; ++k ) {
+			int32_t side = ( area > 0.0f ) == ( face.dot( normals[ t[ k ] ] ) > 0.0f ) ? 1 : -1;
+			mixed[ t[ k ] ] = mixed[ t[ k ] ] || ( sides[ t[ k ] ] != 0 && sides[ t[ k ] ] != side );
+			sides[ t[ k ] ] = side;
+		}
+	}
+	size_t numChecked	= 0;
+	bool signs			= true;
+	for ( size_t i = 0; i < sides.size(); ++i ) {
+		if ( sides[ i ] != 0 && !mixed[ i ] ) {
+			signs = signs && tangents[ i ].w == (float)sides[ i ];
+			++numChecked;
+		}
+	}
+	check( signs && numChecked > 0, name, "tangent w has the wrong sign" );
+}
+
+// Orders positions by x, then y, then z
+static bool isLessPosition( const Vec3f &a, const Vec3f &b )
+{
+	return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+}
+
+/*! Checks that closed-form \a tangents of \a mesh match computeTangents() 
+	within \a maxAngle radians, away from seams and poles, where vertices share 
+	positions, and from vertices whose normal z is below \a minZ. */
+static void checkClosedFormTangents( const char *name, const TriMesh &mesh, const vector<Vec4f> &tangents, 
+	float maxAngle, float minZ )
+{
+	vector<Vec4f> computed			= MeshHelper::computeTangents( mesh );
+	const vector<Vec3f> &positions	= mesh.getVertices();
+	vector<Vec3f> sorted			= positions;
+	sort( sorted.begin(), sorted.end(), isLessPosition );
+	size_t numCompared	= 0;
+	bool same			= computed.size() == tangents.size();
+	for ( size_t i = 0; same && i < positions.size(); ++i ) {
+		pair<vector<Vec3f>::iterator, vector<Vec3f>::iterator> range = equal_range( sorted.begin(), sorted.end(), 
+			positions[ i ], isLessPosition );
+		if ( range.second - range.first > 1 || math<float>::abs( mesh.getNormals()[ i ].z ) < minZ ) {
+			continue;
+		}
+		float cosAngle	= math<float>::clamp( computed[ i ].xyz().dot( tangents[ i ].xyz() ), -1.0f, 1.0f );
+		same			= math<float>::acos( cosAngle ) <= maxAngle && computed[ i ].w == tangents[ i ].w;
+		++numCompared;
+	}
+	check( same && numCompared > 0, name, "closed-form tangents differ from computeTangents" );
+	checkTangents( name, mesh, computed );
+}
+
+static void testTangents()
+{
+	// Flipping s mirrors the texture, which flips every w
+	TriMesh mesh			= createBumpyGrid( Vec2i( 24, 16 ) );
+	MeshHelper::computeNormals( mesh );
+	vector<Vec4f> tangents	= MeshHelper::computeTangents( mesh );
+	checkTangents( "computeTangents", mesh, tangents );
+	vector<Vec2f> &texCoords = mesh.getTexCoords();
+	for ( size_t i = 0; i < texCoords.size(); ++i ) {
+		texCoords[ i ].x = 1.0f - texCoords[ i ].x;
+	}
+	vector<Vec4f> mirrored	= MeshHelper::computeTangents( mesh );
+	checkTangents( "computeTangents mirrored", mesh, mirrored );
+	bool flipped = mirrored.size() == tangents.size();
+	for ( size_t i = 0; flipped && i < tangents.size(); ++i ) {
+		flipped = mirrored[ i ].w == -tangents[ i ].w;
+	}
+	check( flipped, "computeTangents mirrored", "mirroring the texture doesn't flip w" );
+
+	// Tangents share the normals' summation, so they don't depend on the thread count
+	mesh = createBumpyGrid( Vec2i( 200, 200 ) );
+	MeshHelper::computeNormals( mesh );
+	tangents = MeshHelper::computeTangents( mesh, 1 );
+	check( MeshHelper::computeTangents( mesh, 2 ) == tangents && MeshHelper::computeTangents( mesh, 16 ) == tangents, 
+		"computeTangents", "tangents depend on the thread count" );
+
+	// Caps have a single texture coordinate, so only the sides have a tangent to match
+	mesh = MeshHelper::createCylinder( Vec2i( 48, 8 ), tangents, 0.5f, 1.0f );
+	checkTangents( "cylinder tangents", mesh, tangents );
+	mesh = MeshHelper::createCylinder( Vec2i( 48, 8 ), tangents, 0.5f, 1.0f, false, false );
+	checkClosedFormTangents( "cylinder tangents", mesh, tangents, 0.01f, 0.0f );
+	mesh = MeshHelper::createSphere( Vec2i( 48, 24 ), tangents );
+	checkTangents( "sphere tangents", mesh, tangents );
+	checkClosedFormTangents( "sphere tangents", mesh, tangents, 0.01f, 0.2f );
+	mesh = MeshHelper::createTorus( Vec2i( 48, 24 ), tangents, 0.25f );
+	checkTangents( "torus tangents", mesh, tangents );
+	checkClosedFormTangents( "torus tangents", mesh, tangents, 0.01f, 0.0f );
+}
+
+int main()
+{
+	testPrimitives();
+	testSizes();
+	testBounds();
+	testParametric();
+	testSubdivide();
+	testSimplify();
+	testVertexCache();
+	testOverdraw();
+	testVertexFetch();
+	testStripify();
+	testMeshlets();
+	testSplit();
+	testQuantization();
+	testLodChains();
+	testGeomorph();
+	testNormals();
+	testTangents();
+	if ( sNumFailures > 0 ) {
+		printf( "%d checks failed\n", sNumFailures );
+		return 1;
+	}
+	printf( "All checks passed\n" );
+	return 0;
+}